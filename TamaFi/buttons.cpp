@@ -0,0 +1,140 @@
+#include "buttons.h"
+#include "spsc_ring.h"
+#include "power.h"            // powerKick, NO_DEADLINE
+
+#ifdef ESP_PLATFORM
+#include <driver/gpio.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Shared between the ISR and the logic task
+// ---------------------------------------------------------------------------
+// All button interrupts run on the core that attached them and do not nest,
+// so they are a single producer.
+static SpscRing<ButtonEvent, BUTTON_QUEUE_SIZE> queue;
+
+static uint8_t               pins[BUTTON_COUNT];
+static std::atomic<bool>     waitPress[BUTTON_COUNT];     // level the armed interrupt waits for
+static std::atomic<uint32_t> lostPins{0};                 // masked with the queue full
+
+// Logic task only
+static bool     held[BUTTON_COUNT];
+static bool     rearmPending[BUTTON_COUNT];
+static TimeUs   quietUntilUs[BUTTON_COUNT];
+
+static void maskPin(uint8_t i);
+
+static void IRAM_ATTR queueEdge(uint8_t i) {
+    maskPin(i);
+    ButtonEvent ev = { i, waitPress[i].load(std::memory_order_acquire), monoUs() };
+    if (!queue.push(ev)) lostPins.fetch_or(1u << i, std::memory_order_relaxed);
+    powerKick(POWER_LOGIC);
+}
+
+#ifdef ESP_PLATFORM
+// ---------------------------------------------------------------------------
+// ESP32-S3: level interrupts that double as light-sleep wake sources
+// ---------------------------------------------------------------------------
+static void IRAM_ATTR onButtonIrq(void* arg) {
+    queueEdge((uint8_t)(uintptr_t)arg);
+}
+
+static void IRAM_ATTR maskPin(uint8_t i) {
+    gpio_intr_disable((gpio_num_t)pins[i]);
+}
+
+static void armPin(uint8_t i, bool forPress) {
+    waitPress[i].store(forPress, std::memory_order_release);
+    gpio_wakeup_enable((gpio_num_t)pins[i], forPress ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    gpio_intr_enable((gpio_num_t)pins[i]);
+}
+
+static void attachPin(uint8_t i) {
+    waitPress[i].store(true);
+    attachInterruptArg(pins[i], onButtonIrq, (void*)(uintptr_t)i, ONLOW_WE);
+}
+#else
+// ---------------------------------------------------------------------------
+// Host: the stand-in GPIO reports every change; level triggering and
+// masking are emulated here
+// ---------------------------------------------------------------------------
+static std::atomic<bool> armed[BUTTON_COUNT];
+
+static bool atWaitedLevel(uint8_t i) {
+    return (digitalRead(pins[i]) == LOW) == waitPress[i].load();
+}
+
+static void onButtonIrq(void* arg) {
+    uint8_t i = (uint8_t)(uintptr_t)arg;
+    if (armed[i].load() && atWaitedLevel(i)) queueEdge(i);
+}
+
+static void maskPin(uint8_t i) {
+    armed[i].store(false);
+}
+
+static void armPin(uint8_t i, bool forPress) {
+    waitPress[i].store(forPress);
+    armed[i].store(true);
+    if (atWaitedLevel(i)) queueEdge(i);       // a level interrupt fires at once
+}
+
+static void attachPin(uint8_t i) {
+    waitPress[i].store(true);
+    armed[i].store(true);
+    attachInterruptArg(pins[i], onButtonIrq, (void*)(uintptr_t)i, CHANGE);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Logic task
+// ---------------------------------------------------------------------------
+void buttonsInit(const uint8_t* buttonPins) {
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        pins[i]         = buttonPins[i];
+        held[i]         = false;
+        rearmPending[i] = false;
+        attachPin(i);
+    }
+}
+
+bool buttonsPoll(ButtonEvent& ev) {
+    TimeUs now = monoUs();
+
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        if (rearmPending[i] && now >= quietUntilUs[i]) {
+            rearmPending[i] = false;
+            armPin(i, !held[i]);
+        }
+    }
+
+    // The edge is still there: let it fire again now that there is room
+    uint32_t lost = lostPins.exchange(0, std::memory_order_relaxed);
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+        if (lost & (1u << i)) armPin(i, waitPress[i].load());
+
+    if (!queue.pop(ev)) return false;
+
+    held[ev.button]         = ev.pressed;
+    quietUntilUs[ev.button] = ev.at + BUTTON_DEBOUNCE_MS * 1000;
+    rearmPending[ev.button] = true;
+    return true;
+}
+
+bool buttonHeld(uint8_t button) {
+    return button < BUTTON_COUNT && held[button];
+}
+
+bool buttonsHeld() {
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+        if (held[i]) return true;
+    return false;
+}
+
+uint32_t buttonsIdleMs() {
+    TimeMs   now = monoMs();
+    uint32_t ms  = NO_DEADLINE;
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+        if (rearmPending[i]) ms = min(ms, msUntil(now, (quietUntilUs[i] + 999) / 1000));
+    return ms;
+}
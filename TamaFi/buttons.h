@@ -0,0 +1,47 @@
+#pragma once
+#include <Arduino.h>
+#include "monotonic.h"
+
+// ============ Interrupt-driven buttons ============
+//
+// Each button pin has a level-triggered GPIO interrupt that waits for the
+// opposite of the button's debounced state: low while released, high while
+// held. When it fires, the ISR timestamps a press or release, queues it in
+// a lock-free ring and masks the pin. The logic task unmasks the pin once
+// the contact has been quiet for BUTTON_DEBOUNCE_MS, waiting for the other
+// level; if the button already changed meanwhile, the interrupt fires at
+// once, so a short tap is never lost, only delayed to the end of the window.
+//
+// Level triggers also wake the chip from light sleep, so nothing polls,
+// not even while a button is held.
+
+#define BUTTON_DEBOUNCE_MS   10
+#define BUTTON_QUEUE_SIZE    32
+
+enum ButtonId : uint8_t {
+  BUTTON_UP,
+  BUTTON_OK,
+  BUTTON_DOWN,
+  BUTTON_RIGHT1,
+  BUTTON_RIGHT2,
+  BUTTON_RIGHT3,
+  BUTTON_COUNT
+};
+
+struct ButtonEvent {
+  uint8_t button;     // ButtonId
+  bool    pressed;    // false: released
+  TimeUs  at;         // when the edge was seen (ISR)
+};
+
+// pins[] in ButtonId order, already configured INPUT_PULLUP
+void     buttonsInit(const uint8_t* pins);
+
+// Logic task: unmask pins whose window closed, then hand out the next event
+bool     buttonsPoll(ButtonEvent& ev);
+
+bool     buttonHeld(uint8_t button);      // debounced state, as of the last poll
+bool     buttonsHeld();
+
+// Until the next debounce window closes; NO_DEADLINE when none is open
+uint32_t buttonsIdleMs();
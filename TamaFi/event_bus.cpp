@@ -0,0 +1,39 @@
+#include "event_bus.h"
+#include "spsc_ring.h"
+
+#define EV_BIT(t)   (1u << (t))
+
+static_assert(EV_TYPE_COUNT <= 32, "event routes are 32-bit masks");
+
+// Which consumer hears what
+static const uint32_t ROUTES[BUS_CONSUMERS] = {
+    // BUS_SOUND
+    EV_BIT(EV_CLICK) | EV_BIT(EV_FED) | EV_BIT(EV_DISCOVERED) |
+    EV_BIT(EV_REST_STARTED) | EV_BIT(EV_REST_ENDED) | EV_BIT(EV_EVOLVED) |
+    EV_BIT(EV_HATCH_STARTED),
+
+    // BUS_LEDS
+    EV_BIT(EV_FED) | EV_BIT(EV_DISCOVERED) | EV_BIT(EV_SCAN_STARTED) |
+    EV_BIT(EV_ACTIVITY_ENDED) | EV_BIT(EV_FEED_EFFECT_ENDED) |
+    EV_BIT(EV_REST_STARTED) | EV_BIT(EV_ASLEEP) | EV_BIT(EV_REST_ENDED) |
+    EV_BIT(EV_EVOLVED) | EV_BIT(EV_DIED) | EV_BIT(EV_RESET),
+
+    // BUS_UI
+    EV_BIT(EV_HATCH_STARTED) | EV_BIT(EV_DIED)
+};
+
+static SpscRing<PetEvent, BUS_QUEUE_SIZE> rings[BUS_CONSUMERS];
+
+void busPublish(PetEventType type, uint8_t arg) {
+    PetEvent ev = { type, arg, monoUs() };
+    for (int c = 0; c < BUS_CONSUMERS; c++)
+        if (ROUTES[c] & EV_BIT(type)) rings[c].push(ev);
+}
+
+bool busPoll(BusConsumer c, PetEvent& ev) {
+    return c < BUS_CONSUMERS && rings[c].pop(ev);
+}
+
+uint32_t busDropped(BusConsumer c) {
+    return c < BUS_CONSUMERS ? rings[c].dropped() : 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <Arduino.h>
+#include "monotonic.h"
+#include "pet_sim.h"       // PetEventType
+
+// ============ Pet event bus ============
+//
+// The simulation (logic task) says what happened; sound, LEDs and the UI
+// each decide what that means for them. Every consumer has its own
+// fixed-size single-producer / single-consumer ring (spsc_ring.h) and only
+// receives the event types routed to it, so a consumer can move to another
+// task or core without touching the producer. Nothing allocates; a full
+// ring drops the event and counts it.
+//
+// Only the logic task publishes. Sound and LEDs drain their rings at the
+// end of each logic step; the UI drains its ring at the start of a frame.
+// Every UI event comes with a snapshot change, which is what wakes the
+// render task.
+
+#define BUS_QUEUE_SIZE   16
+
+struct PetEvent {
+  PetEventType type;
+  uint8_t      arg;
+  TimeUs       at;
+};
+
+enum BusConsumer : uint8_t {
+  BUS_SOUND,
+  BUS_LEDS,
+  BUS_UI,
+  BUS_CONSUMERS
+};
+
+void     busPublish(PetEventType type, uint8_t arg = 0);     // logic task only
+bool     busPoll(BusConsumer c, PetEvent& ev);               // that consumer only
+uint32_t busDropped(BusConsumer c);
@@ -0,0 +1,173 @@
+#include "gestures.h"
+#include "power.h"            // NO_DEADLINE
+
+#define GESTURE_QUEUE_SIZE   16
+
+struct Track {
+    bool        down;
+    bool        pending;      // press held back, waiting for a chord partner
+    bool        consumed;     // part of a chord: ignored until released
+    bool        longSent;
+    GestureMode mode;
+    uint16_t    repeats;
+    TimeUs      pressedAt;
+    TimeUs      nextAt;       // pending expiry, next repeat or long press
+};
+
+static Track               tracks[BUTTON_COUNT];
+static GestureModeFn       modeFn     = nullptr;
+static const GestureChord* chordTable = nullptr;
+static uint8_t             chordCount = 0;
+
+// Gestures found but not handed out yet (logic task only)
+static Gesture  out[GESTURE_QUEUE_SIZE];
+static uint8_t  outHead = 0, outCount = 0;
+
+static bool emit(GestureKind kind, uint8_t button, uint8_t other = 0, uint16_t repeat = 0) {
+    if (outCount == GESTURE_QUEUE_SIZE) return false;
+    out[(outHead + outCount++) % GESTURE_QUEUE_SIZE] = { kind, button, other, repeat };
+    return true;
+}
+
+static int chordPartner(uint8_t b) {
+    for (uint8_t i = 0; i < chordCount; i++) {
+        if (chordTable[i].a == b) return chordTable[i].b;
+        if (chordTable[i].b == b) return chordTable[i].a;
+    }
+    return -1;
+}
+
+static uint32_t repeatIntervalMs(uint16_t repeats) {
+    int ms = GESTURE_REPEAT_START_MS - (int)repeats * GESTURE_REPEAT_ACCEL_MS;
+    return max(ms, GESTURE_REPEAT_MIN_MS);
+}
+
+// The press is final: report it now or schedule what follows it
+static void startPress(uint8_t b) {
+    Track& t = tracks[b];
+    switch (t.mode) {
+        case GESTURE_MODE_TAP:
+            emit(GESTURE_PRESS, b);
+            break;
+        case GESTURE_MODE_REPEAT:
+            emit(GESTURE_PRESS, b);
+            t.nextAt = t.pressedAt + GESTURE_REPEAT_DELAY_MS * 1000LL;
+            break;
+        case GESTURE_MODE_LONG:
+            t.nextAt = t.pressedAt + GESTURE_LONG_MS * 1000LL;
+            break;
+    }
+}
+
+static bool dueAt(uint8_t b, TimeUs& at) {
+    const Track& t = tracks[b];
+    if (!t.down || t.consumed) return false;
+    if (!t.pending) {
+        if (t.mode == GESTURE_MODE_TAP) return false;
+        if (t.mode == GESTURE_MODE_LONG && t.longSent) return false;
+    }
+    at = t.nextAt;
+    return true;
+}
+
+// Queue every timed gesture due by `limit`, earliest first
+static void advanceTo(TimeUs limit) {
+    while (outCount < GESTURE_QUEUE_SIZE) {
+        int    best   = -1;
+        TimeUs bestAt = 0;
+        for (uint8_t b = 0; b < BUTTON_COUNT; b++) {
+            TimeUs at;
+            if (dueAt(b, at) && at <= limit && (best < 0 || at < bestAt)) { best = b; bestAt = at; }
+        }
+        if (best < 0) return;
+
+        Track& t = tracks[best];
+        if (t.pending) {
+            t.pending = false;
+            startPress(best);
+        } else if (t.mode == GESTURE_MODE_REPEAT) {
+            t.repeats++;
+            emit(GESTURE_REPEAT, best, 0, t.repeats);
+            t.nextAt += repeatIntervalMs(t.repeats) * 1000LL;
+        } else {
+            t.longSent = true;
+            emit(GESTURE_LONG, best);
+        }
+    }
+}
+
+void gestureInit(GestureModeFn mode, const GestureChord* chords, uint8_t count) {
+    modeFn     = mode;
+    chordTable = chords;
+    chordCount = count;
+    memset(tracks, 0, sizeof(tracks));
+    outHead = outCount = 0;
+}
+
+void gestureFeed(const ButtonEvent& ev) {
+    if (ev.button >= BUTTON_COUNT) return;
+    advanceTo(ev.at);                 // what was due before this edge comes first
+
+    Track& t = tracks[ev.button];
+
+    if (!ev.pressed) {
+        if (!t.down) return;
+        if (t.pending || (t.mode == GESTURE_MODE_LONG && !t.longSent && !t.consumed))
+            emit(GESTURE_PRESS, ev.button);
+        t.down    = false;
+        t.pending = false;
+        return;
+    }
+
+    memset(&t, 0, sizeof(t));
+    t.down      = true;
+    t.pressedAt = ev.at;
+    t.mode      = modeFn ? modeFn(ev.button) : GESTURE_MODE_TAP;
+
+    int p = chordPartner(ev.button);
+    if (p < 0) {
+        startPress(ev.button);
+        return;
+    }
+
+    Track& partner = tracks[p];
+    if (partner.down && partner.pending) {
+        partner.pending  = false;
+        partner.consumed = true;
+        t.consumed       = true;
+        emit(GESTURE_CHORD, (uint8_t)p, ev.button);
+        return;
+    }
+
+    t.pending = true;
+    t.nextAt  = ev.at + GESTURE_CHORD_MS * 1000LL;
+}
+
+bool gesturePoll(Gesture& g) {
+    advanceTo(monoUs());
+    if (!outCount) return false;
+    g = out[outHead];
+    outHead = (outHead + 1) % GESTURE_QUEUE_SIZE;
+    outCount--;
+    return true;
+}
+
+bool gestureRepeating() {
+    for (uint8_t b = 0; b < BUTTON_COUNT; b++) {
+        const Track& t = tracks[b];
+        if (t.down && !t.consumed && t.mode == GESTURE_MODE_REPEAT && t.repeats) return true;
+    }
+    return false;
+}
+
+uint32_t gestureIdleMs() {
+    if (outCount) return 0;
+
+    TimeMs   now = monoMs();
+    uint32_t ms  = NO_DEADLINE;
+    for (uint8_t b = 0; b < BUTTON_COUNT; b++) {
+        TimeUs at;
+        if (dueAt(b, at)) ms = min(ms, msUntil(now, (at + 999) / 1000));
+    }
+    return ms;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <Arduino.h>
+#include "buttons.h"
+
+// ============ Button gestures ============
+//
+// Turns the timestamped press/release events from buttons.h into taps,
+// accelerating auto-repeat, long presses and two-button chords. Timing
+// comes from the event stamps and from deadlines the logic task sleeps
+// until (gestureIdleMs()), never from polling the pins.
+//
+// What a press means is decided when it lands, by the mode function the
+// sketch passes in, so it can depend on the screen and the selected row:
+//
+//   TAP      pressed: one GESTURE_PRESS at once
+//   REPEAT   GESTURE_PRESS at once, then after GESTURE_REPEAT_DELAY_MS a
+//            GESTURE_REPEAT every interval while held, the interval
+//            shrinking from GESTURE_REPEAT_START_MS to GESTURE_REPEAT_MIN_MS
+//   LONG     GESTURE_LONG once held GESTURE_LONG_MS; a shorter hold is a
+//            GESTURE_PRESS on release
+//
+// A button that is part of a chord holds its press back for up to
+// GESTURE_CHORD_MS: if the partner goes down in that time the pair is one
+// GESTURE_CHORD and neither press is reported; both are then ignored until
+// released.
+
+#define GESTURE_CHORD_MS          50
+#define GESTURE_LONG_MS           600
+#define GESTURE_REPEAT_DELAY_MS   400
+#define GESTURE_REPEAT_START_MS   150
+#define GESTURE_REPEAT_ACCEL_MS   10     // shorter per repeat ...
+#define GESTURE_REPEAT_MIN_MS     40     // ... down to this
+
+enum GestureMode : uint8_t {
+  GESTURE_MODE_TAP,
+  GESTURE_MODE_REPEAT,
+  GESTURE_MODE_LONG
+};
+
+enum GestureKind : uint8_t {
+  GESTURE_PRESS,
+  GESTURE_REPEAT,
+  GESTURE_LONG,
+  GESTURE_CHORD
+};
+
+struct Gesture {
+  GestureKind kind;
+  uint8_t     button;     // ButtonId; the first of a chord
+  uint8_t     other;      // second button of a chord
+  uint16_t    repeat;     // 1, 2, ... for GESTURE_REPEAT
+};
+
+struct GestureChord {
+  uint8_t a, b;
+};
+
+typedef GestureMode (*GestureModeFn)(uint8_t button);
+
+void     gestureInit(GestureModeFn mode, const GestureChord* chords, uint8_t count);
+
+void     gestureFeed(const ButtonEvent& ev);
+bool     gesturePoll(Gesture& g);          // next gesture due by now, in order
+
+bool     gestureRepeating();               // an auto-repeat is running
+uint32_t gestureIdleMs();                  // until the next timed gesture
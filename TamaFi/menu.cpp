@@ -0,0 +1,36 @@
+#include "menu.h"
+
+// ---------------------------------------------------------------------------
+// VALUE COLUMNS
+// ---------------------------------------------------------------------------
+static const char* levelText(uint8_t index) {
+    return index == 0 ? "Low" : index == 1 ? "Mid" : "High";
+}
+
+const char* menuValueTftBrightness(const UiSnapshot& s, char*, size_t) { return levelText(s.tftBrightnessIndex); }
+const char* menuValueLedBrightness(const UiSnapshot& s, char*, size_t) { return levelText(s.ledBrightnessIndex); }
+const char* menuValueSound(const UiSnapshot& s, char*, size_t)         { return s.soundEnabled ? "On" : "Off"; }
+const char* menuValueNeoPixels(const UiSnapshot& s, char*, size_t)     { return s.neoPixelsEnabled ? "On" : "Off"; }
+const char* menuValueTheme(const UiSnapshot&, char*, size_t)           { return "Pixel"; }
+const char* menuValueAutoSleep(const UiSnapshot& s, char*, size_t)     { return s.autoSleep ? "On" : "Off"; }
+
+const char* menuValueAutoSave(const UiSnapshot& s, char* buf, size_t len) {
+    snprintf(buf, len, "%us", s.autoSaveMs / 1000);
+    return buf;
+}
+
+// ---------------------------------------------------------------------------
+// NAVIGATION
+// ---------------------------------------------------------------------------
+Screen menuNavigate(const MenuDef& m, bool up, bool down, bool ok) {
+    int& cursor = *m.cursor;
+
+    if (up)   cursor = (cursor - 1 + m.count) % m.count;
+    if (down) cursor = (cursor + 1) % m.count;
+
+    if (!ok) return m.screen;
+
+    const MenuItem& item = m.items[cursor];
+    if (item.action) item.action();
+    return item.open;
+}
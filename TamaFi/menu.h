@@ -0,0 +1,142 @@
+#pragma once
+#include <Arduino.h>
+#include "ui.h"
+
+// ============ Table-driven menus ============
+//
+// Every list screen (main menu, controls, settings) is described once by a
+// constexpr MenuDef below. ui.cpp draws any of them with one renderer and
+// handleButtons() drives any of them with menuNavigate(); row positions are
+// computed from the table at compile time.
+
+// Fills buf if it needs to and returns the text for the value column.
+// Runs on the render side, so it reads the snapshot, not the globals.
+typedef const char* (*MenuValueFn)(const UiSnapshot& s, char* buf, size_t len);
+typedef void        (*MenuActionFn)();
+
+enum MenuStyle : uint8_t {
+  MENU_ICONS,       // icon + label, selected label in yellow
+  MENU_BUBBLES      // radio bubble + label + value column
+};
+
+struct MenuItem {
+  const char*  label;
+  MenuValueFn  value;             // nullptr: no value column
+  MenuActionFn action;            // nullptr: nothing to run on OK
+  Screen       open;              // screen shown after OK (the menu's own screen = stay)
+  bool         repeat = false;    // holding OK steps the action again (gestures.h)
+};
+
+// ---------- Layout ----------
+#define MENU_TOP_Y        30    // first icon-style row
+#define MENU_BUBBLE_LIFT  4     // bubble rows sit this much higher
+#define MENU_HILITE_X     8
+#define MENU_HILITE_W     224
+#define MENU_HILITE_H     18
+#define MENU_ICON_X       16
+#define MENU_BUBBLE_X     14
+#define MENU_VALUE_X      150
+#define MENU_FOOTER_X     10
+#define MENU_FOOTER_Y     200
+
+struct MenuDef {
+  Screen          screen;
+  const char*     title;
+  const MenuItem* items;
+  uint8_t         count;
+  uint8_t         rowH;
+  MenuStyle       style;
+  const char*     footer;
+  uint16_t        footerColor;
+  int*            cursor;       // selected row, owned by the main file
+  int UiSnapshot::*shownCursor; // the same row as published to the renderer
+
+  constexpr int textY(int row) const {
+    return MENU_TOP_Y - (style == MENU_BUBBLES ? MENU_BUBBLE_LIFT : 0) + row * rowH;
+  }
+  constexpr int highlightY(int row) const { return textY(row) - 5; }
+  constexpr int labelX() const { return style == MENU_ICONS ? 40 : 30; }
+  constexpr int bottom() const { return highlightY(count - 1) + MENU_HILITE_H; }
+};
+
+// ---------- Value columns (menu.cpp) ----------
+const char* menuValueTftBrightness(const UiSnapshot& s, char* buf, size_t len);
+const char* menuValueLedBrightness(const UiSnapshot& s, char* buf, size_t len);
+const char* menuValueSound(const UiSnapshot& s, char* buf, size_t len);
+const char* menuValueNeoPixels(const UiSnapshot& s, char* buf, size_t len);
+const char* menuValueTheme(const UiSnapshot& s, char* buf, size_t len);
+const char* menuValueAutoSleep(const UiSnapshot& s, char* buf, size_t len);
+const char* menuValueAutoSave(const UiSnapshot& s, char* buf, size_t len);
+
+// ---------- Actions (TamaFi.ino) ----------
+void menuCycleTftBrightness();
+void menuCycleLedBrightness();
+void menuToggleSound();
+void menuToggleNeoPixels();
+void menuToggleAutoSleep();
+void menuCycleAutoSave();
+void menuResetPet();
+void menuResetAll();
+
+// ---------- Tables ----------
+constexpr MenuItem MAIN_MENU_ITEMS[] = {
+  { "Pet Status",  nullptr, nullptr, SCREEN_PET_STATUS  },
+  { "Environment", nullptr, nullptr, SCREEN_ENVIRONMENT },
+  { "System Info", nullptr, nullptr, SCREEN_SYSINFO     },
+  { "Controls",    nullptr, nullptr, SCREEN_CONTROLS    },
+  { "Settings",    nullptr, nullptr, SCREEN_SETTINGS    },
+  { "Diagnostics", nullptr, nullptr, SCREEN_DIAGNOSTICS },
+  { "Back",        nullptr, nullptr, SCREEN_HOME        }
+};
+
+constexpr MenuItem CONTROLS_MENU_ITEMS[] = {
+  { "Screen Brightness", menuValueTftBrightness, menuCycleTftBrightness, SCREEN_CONTROLS, true },
+  { "LED Brightness",    menuValueLedBrightness, menuCycleLedBrightness, SCREEN_CONTROLS, true },
+  { "Sound",             menuValueSound,         menuToggleSound,        SCREEN_CONTROLS },
+  { "NeoPixels",         menuValueNeoPixels,     menuToggleNeoPixels,    SCREEN_CONTROLS },
+  { "Back",              nullptr,                nullptr,                SCREEN_MENU     }
+};
+
+constexpr MenuItem SETTINGS_MENU_ITEMS[] = {
+  { "Theme",      menuValueTheme,     nullptr,             SCREEN_SETTINGS },
+  { "Auto Sleep", menuValueAutoSleep, menuToggleAutoSleep, SCREEN_SETTINGS },
+  { "Auto Save",  menuValueAutoSave,  menuCycleAutoSave,   SCREEN_SETTINGS, true },
+  { "Reset Pet",  nullptr,            menuResetPet,        SCREEN_SETTINGS },
+  { "Reset All",  nullptr,            menuResetAll,        SCREEN_HATCH    },
+  { "Back",       nullptr,            nullptr,             SCREEN_MENU     }
+};
+
+#define MENU_ITEM_COUNT(items) (uint8_t)(sizeof(items) / sizeof(items[0]))
+
+constexpr MenuDef MAIN_MENU = {
+  SCREEN_MENU, "Main Menu", MAIN_MENU_ITEMS, MENU_ITEM_COUNT(MAIN_MENU_ITEMS),
+  20, MENU_ICONS, "UP/DOWN = move | OK = select", TFT_WHITE,
+  &mainMenuIndex, &UiSnapshot::mainMenuIndex
+};
+
+constexpr MenuDef CONTROLS_MENU = {
+  SCREEN_CONTROLS, "Controls", CONTROLS_MENU_ITEMS, MENU_ITEM_COUNT(CONTROLS_MENU_ITEMS),
+  20, MENU_BUBBLES, "OK = Select/Back", TFT_CYAN,
+  &controlsIndex, &UiSnapshot::controlsIndex
+};
+
+constexpr MenuDef SETTINGS_MENU = {
+  SCREEN_SETTINGS, "Settings", SETTINGS_MENU_ITEMS, MENU_ITEM_COUNT(SETTINGS_MENU_ITEMS),
+  18, MENU_BUBBLES, "OK = Select", TFT_CYAN,
+  &settingsMenuIndex, &UiSnapshot::settingsMenuIndex
+};
+
+static_assert(MAIN_MENU.bottom()     < MENU_FOOTER_Y, "Main menu overlaps its footer");
+static_assert(CONTROLS_MENU.bottom() < MENU_FOOTER_Y, "Controls menu overlaps its footer");
+static_assert(SETTINGS_MENU.bottom() < MENU_FOOTER_Y, "Settings menu overlaps its footer");
+
+// Menu drawn on a screen, or nullptr for ordinary pages
+constexpr const MenuDef* menuFor(Screen s) {
+  return s == SCREEN_MENU     ? &MAIN_MENU :
+         s == SCREEN_CONTROLS ? &CONTROLS_MENU :
+         s == SCREEN_SETTINGS ? &SETTINGS_MENU : nullptr;
+}
+
+// Moves the cursor on UP/DOWN (wrapping) and runs the selected item on OK.
+// Returns the screen to show next.
+Screen menuNavigate(const MenuDef& m, bool up, bool down, bool ok);
@@ -0,0 +1,32 @@
+#include "monotonic.h"
+#include "trace.h"
+
+#ifdef ESP_PLATFORM
+#if TAMAFI_TRACE
+// Also read from the button ISR
+TimeUs IRAM_ATTR monoUs() {
+    return traceClock(esp_timer_get_time());
+}
+#endif
+#else
+// ---------------------------------------------------------------------------
+// Host: steady clock from the first call, unless a source was injected
+// ---------------------------------------------------------------------------
+#include <chrono>
+
+static TimeUs steadyUs() {
+    static const auto origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - origin).count();
+}
+
+static MonoSource source = steadyUs;
+
+TimeUs monoUs() {
+    return traceClock(source());
+}
+
+void monoSetSource(MonoSource src) {
+    source = src ? src : steadyUs;
+}
+#endif
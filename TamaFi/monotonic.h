@@ -0,0 +1,43 @@
+#pragma once
+#include <Arduino.h>
+
+// ============ Monotonic time ============
+//
+// One 64-bit microsecond count since boot for every scheduler and
+// animation. It cannot wrap in the life of the device, so "is it due" is
+// a plain signed comparison; millis() and micros() wrap after ~49.7 days
+// and ~71 minutes and are not used for timing.
+//
+// On the ESP32-S3 this is esp_timer_get_time(). On the host the source is
+// injectable, so a virtual clock can run the firmware through weeks of
+// uptime in seconds.
+//
+// With TAMAFI_TRACE each read is a recorded input (trace.h).
+
+typedef int64_t TimeUs;
+typedef int64_t TimeMs;
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+
+#if defined(TAMAFI_TRACE) && TAMAFI_TRACE
+TimeUs monoUs();                                    // every read goes through trace.h
+#else
+inline TimeUs monoUs() { return esp_timer_get_time(); }
+#endif
+#else
+typedef TimeUs (*MonoSource)();
+
+TimeUs monoUs();
+void   monoSetSource(MonoSource src);   // nullptr: the host's steady clock
+#endif
+
+inline TimeMs monoMs() { return monoUs() / 1000; }
+
+// Milliseconds from now until due: 0 when due or overdue, and never
+// UINT32_MAX (NO_DEADLINE in power.h) however far away
+inline uint32_t msUntil(TimeMs now, TimeMs due) {
+  TimeMs d = due - now;
+  if (d <= 0) return 0;
+  return d < (TimeMs)UINT32_MAX ? (uint32_t)d : UINT32_MAX - 1;
+}
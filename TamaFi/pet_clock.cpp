@@ -0,0 +1,35 @@
+#include "pet_clock.h"
+
+// Pet time is kept in microseconds from the last change of scale, so a
+// fast clock still moves in steps far below a millisecond
+static uint32_t scale      = TAMAFI_TIME_SCALE;
+static TimeUs   anchorReal = 0;
+static TimeUs   anchorPet  = 0;
+
+static TimeUs petUs(TimeUs realUs) {
+    return anchorPet + (realUs - anchorReal) * scale;
+}
+
+TimeMs petClockMs() {
+    return petUs(monoUs()) / 1000;
+}
+
+uint32_t petClockScale() {
+    return scale;
+}
+
+void petClockSetScale(uint32_t s) {
+    if (s < 1) s = 1;
+    if (s > PET_CLOCK_MAX_SCALE) s = PET_CLOCK_MAX_SCALE;
+
+    TimeUs now = monoUs();
+    anchorPet  = petUs(now);
+    anchorReal = now;
+    scale      = s;
+}
+
+uint32_t petClockMsUntil(TimeMs due) {
+    TimeMs now = petClockMs();
+    if (due <= now) return 0;
+    return msUntil(0, (due - now + scale - 1) / scale);
+}
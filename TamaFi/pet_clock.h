@@ -0,0 +1,35 @@
+#pragma once
+#include <Arduino.h>
+#include "monotonic.h"
+
+// ============ Pet clock ============
+//
+// The time PetSim lives in: monotonic time run faster by a whole scale
+// factor, so hours of decay, ageing and evolution can be watched in
+// minutes. Everything the pet's rules time (decay, decisions, rest,
+// ageing) runs on it; buttons, sound, LEDs, the WiFi scan and every frame
+// drawn stay on real time.
+//
+// PetSim works out every step between two advance() calls, so nothing is
+// skipped however far the clock moves between wake-ups; a faster clock
+// only means waking more often. The clock is continuous across a change
+// of scale.
+//
+// TAMAFI_TIME_SCALE sets the scale at boot; Diagnostics changes it while
+// running (hold UP). It is not saved.
+
+#ifndef TAMAFI_TIME_SCALE
+#define TAMAFI_TIME_SCALE   1
+#endif
+
+#define PET_CLOCK_MAX_SCALE 10000
+
+static_assert(TAMAFI_TIME_SCALE >= 1 && TAMAFI_TIME_SCALE <= PET_CLOCK_MAX_SCALE,
+              "TAMAFI_TIME_SCALE must be 1 .. 10000");
+
+TimeMs   petClockMs();
+uint32_t petClockScale();
+void     petClockSetScale(uint32_t scale);          // 1 .. PET_CLOCK_MAX_SCALE
+
+// Real milliseconds until the pet clock reaches due, rounded up, as msUntil()
+uint32_t petClockMsUntil(TimeMs due);
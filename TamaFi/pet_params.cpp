@@ -0,0 +1,88 @@
+#include "pet_params.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ParamField {
+    const char* name;
+    int32_t PetParams::* field;
+    int32_t least, most;
+};
+
+static const ParamField FIELDS[] = {
+    { "version", &PetParams::version, INT32_MIN, INT32_MAX },
+#define PET_PARAM_ENTRY(name, def, least, most) { #name, &PetParams::name, least, most },
+    PET_PARAMS(PET_PARAM_ENTRY)
+#undef PET_PARAM_ENTRY
+};
+
+static char errorText[80];
+
+static const char* fail(int line, const char* what, const char* name, size_t len) {
+    snprintf(errorText, sizeof(errorText), "line %d: %s '%.*s'", line, what, (int)len, name);
+    return errorText;
+}
+
+static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// ---- parser ----
+// One "name = value" per line; blank lines and everything after '#' are
+// skipped. Values are decimal and may be negative; each must lie within
+// its field's bounds, and a minimum may not exceed its maximum.
+
+const char* petParamsParse(PetParams& out, const char* text) {
+    PetParams p = out;
+    p.version = 0;
+
+    int line = 0;
+    for (const char* s = text; *s; ) {
+        line++;
+        const char* end = strchr(s, '\n');
+        if (!end) end = s + strlen(s);
+        const char* hash = (const char*)memchr(s, '#', end - s);
+        const char* stop = hash ? hash : end;
+
+        while (s < stop && isBlank(*s)) s++;
+        if (s < stop) {
+            const char* name = s;
+            while (s < stop && !isBlank(*s) && *s != '=') s++;
+            size_t nameLen = s - name;
+            while (s < stop && isBlank(*s)) s++;
+            if (s == stop || *s != '=') return fail(line, "expected '=' after", name, nameLen);
+            s++;
+
+            const ParamField* f = nullptr;
+            for (const ParamField& c : FIELDS)
+                if (strlen(c.name) == nameLen && !memcmp(c.name, name, nameLen)) f = &c;
+            if (!f) return fail(line, "no such field", name, nameLen);
+
+            while (s < stop && isBlank(*s)) s++;
+            if (s == stop) return fail(line, "no value for", name, nameLen);
+            char* after;
+            errno = 0;
+            long v = strtol(s, &after, 10);      // long is 32 bits on the device
+            const char* rest = after;
+            while (rest < stop && isBlank(*rest)) rest++;
+            if (after == s || rest != stop) return fail(line, "not a number for", name, nameLen);
+            if (errno == ERANGE || v < f->least || v > f->most) {
+                snprintf(errorText, sizeof(errorText), "line %d: '%.*s' outside %ld .. %ld",
+                         line, (int)nameLen, name, (long)f->least, (long)f->most);
+                return errorText;
+            }
+            p.*(f->field) = (int32_t)v;
+        }
+        s = *end ? end + 1 : end;
+    }
+
+    if (p.version == 0) return "no version line";
+    if (p.version != PET_PARAMS_VERSION) {
+        snprintf(errorText, sizeof(errorText), "version %ld, this build reads %d",
+                 (long)p.version, PET_PARAMS_VERSION);
+        return errorText;
+    }
+    if (p.decisionMinMs > p.decisionMaxMs) return "decisionMinMs above decisionMaxMs";
+    if (p.restMinMs > p.restMaxMs)         return "restMinMs above restMaxMs";
+    out = p;
+    return nullptr;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <stdint.h>
+
+// ============ Balance parameters ============
+//
+// Every number that tunes the pet's life rather than its logic: decay
+// periods and steps, what a hunt, a discovery or a rest pays out, the
+// desires behind an autonomous decision, mood and evolution thresholds.
+// The defines below are the build's defaults; PetParams holds one value
+// per field and PetSim reads them straight from its own copy, a flat
+// struct of int32_t, so a tuned table costs a load where a literal stood.
+//
+// A table can be given as text, so balance changes need no rebuild:
+//
+//   # comment
+//   version = 1
+//   huntHungerMax = 40
+//
+// Fields left out keep their default. The firmware reads the text from
+// the NVS blob "params" at boot; host tools take a file (--params). A
+// table whose version is not PET_PARAMS_VERSION, that names a field this
+// build does not have, gives a field something other than a number or a
+// number outside the field's bounds, or whose minimum exceeds its maximum
+// is refused whole: a period of 0 would stall the logic task and a bad
+// table in NVS is read on every boot. Bump the version whenever a field
+// changes meaning.
+//
+// Nothing but <stdint.h>, like pet_sim.h.
+
+#define PET_PARAMS_VERSION       1
+
+#define HUNGER_DECAY_MS          5000
+#define HAPPINESS_DECAY_MS       7000
+#define HEALTH_DECAY_MS          10000
+#define AGE_TICK_MS              60000
+#define WIFI_BORED_MS            30000   // no networks for this long: bored, sadder
+#define WIFI_SICK_MS             60000   // ... and this long: sick
+
+#define DECISION_INTERVAL_MIN    8000
+#define DECISION_INTERVAL_MAX    15000
+#define DECISION_INTERVAL_FIRST  10000
+
+#define REST_MIN_DURATION        5000
+#define REST_MAX_DURATION        15000
+
+#define PARAM_MS_MAX             86400000   // a day: the longest any period may be
+
+// name, default, least, most
+#define PET_PARAMS(X)                                                   \
+  /* decay: points lost per period */                                   \
+  X(hungerDecayMs,        HUNGER_DECAY_MS,         1,    PARAM_MS_MAX)  \
+  X(happinessDecayMs,     HAPPINESS_DECAY_MS,      1,    PARAM_MS_MAX)  \
+  X(healthDecayMs,        HEALTH_DECAY_MS,         1,    PARAM_MS_MAX)  \
+  X(ageTickMs,            AGE_TICK_MS,             1,    PARAM_MS_MAX)  \
+  X(hungerDecay,          2,                       0,    100)           \
+  X(happinessDecay,       1,                       0,    100)           \
+  /* happiness lost per period once bored */                            \
+  X(happinessDecayQuiet,  3,                       0,    100)           \
+  X(healthDecay,          1,                       0,    100)           \
+  X(healthDecayStarving,  2,                       0,    100)           \
+  /* hunger or happiness below this: starving */                        \
+  X(starvingBelow,        20,                      0,    100)           \
+  X(wifiBoredMs,          WIFI_BORED_MS,           1,    PARAM_MS_MAX)  \
+  X(wifiSickMs,           WIFI_SICK_MS,            1,    PARAM_MS_MAX)  \
+  /* mood: health, hunger below; happiness, networks above */           \
+  X(sickBelow,            25,                      0,    100)           \
+  X(hungryBelow,          25,                      0,    100)           \
+  X(excitedAbove,         80,                      0,    100)           \
+  X(excitedNetsAbove,     8,                       0,    255)           \
+  X(happyAbove,           60,                      0,    100)           \
+  /* evolution: age in minutes, average of the three stats */           \
+  X(teenAge,              20,                      0,    1000000)       \
+  X(teenWellbeing,        35,                      0,    100)           \
+  X(adultAge,             60,                      0,    1000000)       \
+  X(adultWellbeing,       45,                      0,    100)           \
+  X(elderAge,             180,                     0,    1000000)       \
+  X(elderWellbeing,       40,                      0,    100)           \
+  /* autonomous decisions */                                            \
+  X(decisionFirstMs,      DECISION_INTERVAL_FIRST, 1,    PARAM_MS_MAX)  \
+  X(decisionMinMs,        DECISION_INTERVAL_MIN,   1,    PARAM_MS_MAX)  \
+  X(decisionMaxMs,        DECISION_INTERVAL_MAX,   1,    PARAM_MS_MAX)  \
+  X(desireIdle,           10,                      0,    1000)          \
+  X(desireDiscPerHidden,  10,                      0,    1000)          \
+  X(desireDiscPerOpen,    6,                       0,    1000)          \
+  X(desireDiscPerNet,     2,                       0,    1000)          \
+  /* 0 .. this - 1 added to the discovery desire */                     \
+  X(desireDiscJitter,     20,                      0,    256)           \
+  X(restHungryBelow,      20,                      0,    100)           \
+  X(restHungryPenalty,    10,                      0,    1000)          \
+  X(hungryHuntBonus,      20,                      0,    1000)          \
+  X(hungryRestPenalty,    10,                      0,    1000)          \
+  X(curiousDiscBonus,     15,                      0,    1000)          \
+  X(sickRestBonus,        20,                      0,    1000)          \
+  X(sickDiscPenalty,      10,                      0,    1000)          \
+  /* while excited or bored */                                          \
+  X(restlessDiscBonus,    10,                      0,    1000)          \
+  X(restlessHuntBonus,    5,                       0,    1000)          \
+  /* rest */                                                            \
+  X(restMinMs,            REST_MIN_DURATION,       1,    PARAM_MS_MAX)  \
+  X(restMaxMs,            REST_MAX_DURATION,       1,    PARAM_MS_MAX)  \
+  X(restHunger,           -3,                      -100, 100)           \
+  X(restHappiness,        10,                      -100, 100)           \
+  X(restHealth,           15,                      -100, 100)           \
+  /* hunt */                                                            \
+  X(huntEmptyHunger,      -15,                     -100, 100)           \
+  X(huntEmptyHappiness,   -10,                     -100, 100)           \
+  X(huntEmptyHealth,      -5,                      -100, 100)           \
+  X(huntHungerPerNet,     2,                       0,    100)           \
+  X(huntHungerPerStrong,  3,                       0,    100)           \
+  X(huntHungerMax,        35,                      0,    100)           \
+  /* hunt joy: hidden count twice, open once */                         \
+  X(huntHappyPerVariety,  3,                       0,    100)           \
+  X(huntHappyMax,         30,                      0,    100)           \
+  X(huntFairRssi,         -75,                     -120, 0)             \
+  X(huntGoodRssi,         -65,                     -120, 0)             \
+  /* health above each RSSI */                                          \
+  X(huntRssiHealth,       5,                       -100, 100)           \
+  X(huntStrongOver,       5,                       0,    255)           \
+  X(huntStrongHealth,     3,                       -100, 100)           \
+  /* discovery */                                                       \
+  X(discEmptyHappiness,   -5,                      -100, 100)           \
+  X(discEmptyHunger,      -3,                      -100, 100)           \
+  /* curiosity per network, of which half is joy */                     \
+  X(discPerHidden,        4,                       0,    100)           \
+  X(discPerOpen,          3,                       0,    100)           \
+  X(discPerNet,           1,                       0,    100)           \
+  X(discHappyMax,         35,                      0,    100)           \
+  X(discHunger,           -5,                      -100, 100)
+
+struct PetParams {
+  int32_t version = PET_PARAMS_VERSION;
+#define PET_PARAM_FIELD(name, def, least, most) int32_t name = def;
+  PET_PARAMS(PET_PARAM_FIELD)
+#undef PET_PARAM_FIELD
+};
+
+// Overrides the fields `text` names; out is untouched unless the whole
+// table is good. Returns nullptr, or what was wrong and on which line.
+const char* petParamsParse(PetParams& out, const char* text);
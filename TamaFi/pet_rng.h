@@ -0,0 +1,60 @@
+#pragma once
+#include <stdint.h>
+
+// ============ Random streams ============
+//
+// PCG32 (O'Neill, pcg-random.org): a 64-bit LCG whose state is turned
+// into 32 output bits by an xorshift and a rotation the state itself
+// picks. 16 bytes of state, and a draw is one 64-bit multiply-add, two
+// shifts and a rotate: no table, no division, no peripheral to wait on.
+//
+// The increment selects the stream: generators seeded alike but on
+// different streams run through unrelated sequences. Each subsystem that
+// draws gets its own, so a draw added to one leaves the others' sequences
+// as they were, and everything still follows from a single seed
+// (esp_random() at boot on the device, a number on the host).
+//
+// Nothing but <stdint.h>, like pet_sim.h, so host tools use it as is.
+
+enum PetStream : uint8_t {
+  PET_STREAM_DECISION,     // decision interval, desire jitter
+  PET_STREAM_REST,         // rest duration
+  PET_STREAM_TRAITS,       // a new pet's character
+  PET_STREAMS              // host tools number their own streams from here
+};
+
+struct Pcg32 {
+  uint64_t state = 0x853C49E6748FEA9BULL;     // the reference generator's default
+  uint64_t inc   = 0xDA3E39CB94B95BDBULL;
+
+  void begin(uint64_t seed, uint64_t stream) {
+    state = 0;
+    inc   = (stream << 1) | 1;
+    next();
+    state += seed;
+    next();
+  }
+
+  uint32_t next() {
+    uint64_t old = state;
+    state = old * 6364136223846793005ULL + inc;
+    uint32_t x   = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (x >> rot) | (x << ((0u - rot) & 31));
+  }
+
+  // In [lo, hi), as Arduino's random(lo, hi), but unbiased: the bound is
+  // scaled by a multiply and the few draws that would favour the low end
+  // are redrawn (Lemire), where `% n` would skew every bound that is not
+  // a power of two
+  int32_t range(int32_t lo, int32_t hi) {
+    if (hi <= lo) return lo;
+    uint32_t bound = (uint32_t)(hi - lo);
+    uint64_t m = (uint64_t)next() * bound;
+    if ((uint32_t)m < bound) {
+      uint32_t floor = (0u - bound) % bound;
+      while ((uint32_t)m < floor) m = (uint64_t)next() * bound;
+    }
+    return lo + (int32_t)(m >> 32);
+  }
+};
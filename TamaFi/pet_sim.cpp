@@ -0,0 +1,693 @@
+#include "pet_sim.h"
+#include "ui_anim.h"          // rest and hunger overlay pacing
+
+static inline int clampStat(int v) {
+    return v < 0 ? 0 : v > 100 ? 100 : v;
+}
+
+static inline uint8_t saturate(int v) {
+    return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static inline TimeMs earlier(TimeMs a, TimeMs b) {
+    return a < b ? a : b;
+}
+
+// ---- decay arithmetic ----
+// Ticks fall at next, next + period, ...; all counts are of ticks in a
+// closed time range.
+
+static int64_t ticksIn(TimeMs next, uint32_t period, TimeMs from, TimeMs to) {
+    if (from < next) from = next;
+    if (to < from) return 0;
+    int64_t first = (from - next + period - 1) / period;
+    int64_t last  = (to - next) / period;
+    return last >= first ? last - first + 1 : 0;
+}
+
+static TimeMs tickAfter(TimeMs next, uint32_t period, TimeMs t) {
+    return next > t ? next : next + ((t - next) / period + 1) * period;
+}
+
+static int64_t ceilDiv(int64_t a, int64_t b) {
+    return (a + b - 1) / b;
+}
+
+// ---- setup ----
+
+void PetSim::setParams(const PetParams& p) { _p = p; }
+
+void PetSim::begin(TimeMs now, uint32_t seed) {
+    for (int s = 0; s <= PET_STREAM_REST; s++) _rng[s].begin(seed, s);
+    buildCatalogue();
+    for (int r = 0; r < RULE_COUNT; r++) stop((Rule)r);
+    startDecay(now);
+    start(RULE_DECISION, now + _p.decisionFirstMs);
+    _decisionDue = false;
+}
+
+void PetSim::setEventSink(PetEventFn fn, void* ctx) {
+    _sink    = fn;
+    _sinkCtx = ctx;
+}
+
+void PetSim::setDecisionTrace(PetDecisionFn fn, void* ctx) {
+    _decisionFn  = fn;
+    _decisionCtx = ctx;
+}
+
+void PetSim::setTicking(bool on)    { _ticking = on; }
+void PetSim::setAutonomous(bool on) { _autonomous = on; }
+
+// ---- scheduling ----
+
+void PetSim::start(Rule r, TimeMs at, uint32_t periodMs) {
+    _due[r]    = at;
+    _period[r] = periodMs;
+}
+
+uint32_t PetSim::period(Stat s) const {
+    switch (s) {
+        case STAT_HUNGER:    return _p.hungerDecayMs;
+        case STAT_HAPPINESS: return _p.happinessDecayMs;
+        case STAT_HEALTH:    return _p.healthDecayMs;
+        default:             return _p.ageTickMs;
+    }
+}
+
+// Decay and ageing restart their periods from now
+void PetSim::startDecay(TimeMs now) {
+    _statAt = now;
+    for (int k = 0; k < STAT_COUNT; k++) _tick[k] = now + period((Stat)k);
+}
+
+void PetSim::advance(TimeMs now) {
+    TimeMs ticked = PET_NEVER;                  // last instant evaluated here
+    for (;;) {
+        TimeMs t = nextCrossing();
+        for (int r = 0; r < RULE_COUNT; r++)
+            if (_due[r] < t) t = _due[r];
+        if (t > now) break;
+
+        materialize(t);
+        for (int r = 0; r < RULE_COUNT; r++) {
+            if (_due[r] != t) continue;
+            _due[r] = _period[r] ? t + _period[r] : PET_NEVER;
+            fire((Rule)r, t);
+        }
+        tick(t);
+        ticked = t;
+    }
+    materialize(now);
+    if (ticked != now) tick(now);
+}
+
+TimeMs PetSim::nextDue(TimeMs now) const {
+    TimeMs next = nextCrossing();
+    for (int r = 0; r < RULE_COUNT; r++) {
+        if (r == RULE_DECISION && !_autonomous) continue;   // picked up on the way back
+        next = earlier(next, _due[r]);
+    }
+    return next > now ? next : now;
+}
+
+TimeMs PetSim::nextStatChange() const {
+    if (!_ticking) return PET_NEVER;
+    TimeMs next = _tick[STAT_AGE];
+    if (state.pet.hunger > 0)    next = earlier(next, _tick[STAT_HUNGER]);
+    if (state.pet.happiness > 0) next = earlier(next, _tick[STAT_HAPPINESS]);
+    if (state.pet.health > 0)    next = earlier(next, _tick[STAT_HEALTH]);
+    return next;
+}
+
+// ---- closed-form decay ----
+
+int PetSim::valueAt(const DecayLine& d, TimeMs t) {
+    int64_t early = ticksIn(d.next, d.period, d.next, earlier(t, d.switchAt - 1));
+    int64_t late  = ticksIn(d.next, d.period, d.switchAt, t);
+    int64_t v     = d.value - d.early * early - d.late * late;
+    return v > 0 ? (int)v : 0;
+}
+
+// First tick at which the stat is below `threshold`; PET_NEVER if it
+// already is or never will be
+TimeMs PetSim::whenBelow(const DecayLine& d, int threshold) {
+    if (d.value < threshold) return PET_NEVER;
+    int64_t need = d.value - threshold + 1;
+
+    int64_t earlyTicks = d.switchAt == PET_NEVER ? INT64_MAX
+                       : ticksIn(d.next, d.period, d.next, d.switchAt - 1);
+    if (d.early > 0) {
+        int64_t k = ceilDiv(need, d.early);
+        if (k <= earlyTicks) return d.next + (k - 1) * d.period;
+    }
+    if (earlyTicks == INT64_MAX || d.late <= 0) return PET_NEVER;
+
+    need -= d.early * earlyTicks;
+    return d.next + (earlyTicks + ceilDiv(need, d.late) - 1) * d.period;
+}
+
+PetSim::DecayLine PetSim::line(Stat s) const {
+    const Pet& pet = state.pet;
+    int on = _ticking ? 1 : 0;
+
+    switch (s) {
+        case STAT_HUNGER:
+            return { pet.hunger, _tick[s], period(s), _p.hungerDecay * on, _p.hungerDecay * on, PET_NEVER };
+
+        // Faster once no network has been seen for wifiBoredMs
+        case STAT_HAPPINESS:
+            return { pet.happiness, _tick[s], period(s), _p.happinessDecay * on, _p.happinessDecayQuiet * on,
+                     state.wifi.netCount == 0 ? state.lastScanMs + _p.wifiBoredMs + 1 : PET_NEVER };
+
+        // Faster from the instant hunger or happiness drops below
+        // starvingBelow; a health tick at that instant comes after theirs
+        case STAT_HEALTH: {
+            TimeMs starving = _statAt;
+            if (pet.hunger >= _p.starvingBelow && pet.happiness >= _p.starvingBelow)
+                starving = earlier(whenBelow(line(STAT_HUNGER), _p.starvingBelow),
+                                   whenBelow(line(STAT_HAPPINESS), _p.starvingBelow));
+            return { pet.health, _tick[s], period(s), _p.healthDecay * on, _p.healthDecayStarving * on, starving };
+        }
+
+        default:
+            return { 0, _tick[s], period(s), 0, 0, PET_NEVER };
+    }
+}
+
+// Bring the stats and the age forward to t
+void PetSim::materialize(TimeMs t) {
+    if (t <= _statAt) return;
+
+    DecayLine hunger    = line(STAT_HUNGER);
+    DecayLine happiness = line(STAT_HAPPINESS);
+    DecayLine health    = line(STAT_HEALTH);
+
+    Pet& pet = state.pet;
+    pet.hunger    = valueAt(hunger, t);
+    pet.happiness = valueAt(happiness, t);
+    pet.health    = valueAt(health, t);
+
+    if (_ticking) {
+        int64_t minutes = pet.ageMinutes + ticksIn(_tick[STAT_AGE], _p.ageTickMs, _tick[STAT_AGE], t);
+        int64_t hours   = pet.ageHours + minutes / 60;
+        pet.ageMinutes  = minutes % 60;
+        pet.ageDays    += hours / 24;
+        pet.ageHours    = hours % 24;
+    }
+
+    for (int k = 0; k < STAT_COUNT; k++) _tick[k] = tickAfter(_tick[k], period((Stat)k), t);
+    _statAt = t;
+}
+
+// The next instant, after _statAt, at which the rules could decide
+// something different: a stat crossing a mood or death threshold, the age
+// reaching an evolution step, the air turning boring or sickening
+TimeMs PetSim::nextCrossing() const {
+    DecayLine hunger    = line(STAT_HUNGER);
+    DecayLine happiness = line(STAT_HAPPINESS);
+    DecayLine health    = line(STAT_HEALTH);
+
+    TimeMs next = PET_NEVER;
+    next = earlier(next, whenBelow(hunger, _p.hungryBelow));
+    next = earlier(next, whenBelow(hunger, 1));
+    next = earlier(next, whenBelow(happiness, _p.excitedAbove + 1));
+    next = earlier(next, whenBelow(happiness, _p.happyAbove + 1));
+    next = earlier(next, whenBelow(happiness, 1));
+    next = earlier(next, whenBelow(health, _p.sickBelow));
+    next = earlier(next, whenBelow(health, 1));
+    next = earlier(next, nextEvolution());
+
+    if (state.wifi.netCount == 0) {
+        TimeMs bored = state.lastScanMs + _p.wifiBoredMs + 1;
+        TimeMs sick  = state.lastScanMs + _p.wifiSickMs + 1;
+        // Either may come first: the table only bounds each on its own
+        if (bored > _statAt)                 next = earlier(next, bored);
+        if (state.scanned && sick > _statAt) next = earlier(next, sick);
+    }
+    return next;
+}
+
+// When counting minutes next brings the pet to an evolution step it is
+// well enough for. ageMinutes rolls over into hours at 60, so a step at
+// 60 minutes or more is never reached this way. Decay only lowers the
+// average, so a pet too weak for a step now stays too weak until
+// something feeds it.
+TimeMs PetSim::nextEvolution() const {
+    const Pet& pet = state.pet;
+    if (!_ticking) return PET_NEVER;
+
+    const int32_t steps[][3] = {
+        { STAGE_TEEN,  _p.teenAge,  _p.teenWellbeing  },
+        { STAGE_ADULT, _p.adultAge, _p.adultWellbeing },
+        { STAGE_ELDER, _p.elderAge, _p.elderWellbeing },
+    };
+    int    avg  = (pet.hunger + pet.happiness + pet.health) / 3;
+    TimeMs next = PET_NEVER;
+    for (const auto& st : steps) {
+        if (state.stage >= st[0] || st[1] >= 60 || avg <= st[2]) continue;
+        int64_t m    = pet.ageMinutes;
+        int64_t need = m < st[1] ? st[1] - m : 60 - m + st[1];
+        next = earlier(next, _tick[STAT_AGE] + (need - 1) * _p.ageTickMs);
+    }
+    return next;
+}
+
+// ---- timed rules ----
+
+void PetSim::fire(Rule r, TimeMs t) {
+    switch (r) {
+        // Only raises the flag; the decision waits until the pet is idle
+        case RULE_DECISION:
+            _decisionDue = true;
+            break;
+
+        case RULE_REST:
+            stepRest(t);
+            break;
+
+        case RULE_HUNGER_FX:
+            state.hungerEffectFrame++;
+            if (state.hungerEffectFrame >= HUNGER_FRAME_COUNT) {
+                state.hungerEffectActive = false;
+                stop(RULE_HUNGER_FX);
+                emit(EV_FEED_EFFECT_ENDED, t);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Re-evaluated after every batch of rules and on every advance()
+void PetSim::tick(TimeMs t) {
+    if (!_ticking) return;
+
+    updateMood(t);
+    updateEvolution(t);
+
+    Pet& pet = state.pet;
+    if (!state.dead && pet.hunger <= 0 && pet.happiness <= 0 && pet.health <= 0) {
+        state.dead      = true;
+        state.activity  = ACT_NONE;
+        state.restPhase = REST_NONE;
+        emit(EV_DIED, t);
+    }
+
+    if (_autonomous && !state.dead &&
+        state.activity == ACT_NONE && state.restPhase == REST_NONE) {
+        decide(t);
+    }
+}
+
+// ---- mood & evolution ----
+
+// Which side of each threshold the mood rules test every input is on.
+// The air turns boring and sickening at fixed times after the last scan,
+// worked out once per scan, so time costs two comparisons.
+uint16_t PetSim::moodKey(TimeMs t) {
+    const Pet&       pet  = state.pet;
+    const WifiStats& wifi = state.wifi;
+
+    if (state.lastScanMs != _airFrom) {
+        _airFrom = state.lastScanMs;
+        _boredAt = _airFrom + _p.wifiBoredMs + 1;
+        _sickAt  = _airFrom + _p.wifiSickMs + 1;
+    }
+    bool quiet = wifi.netCount == 0;
+
+    return (pet.health < _p.sickBelow)                           |
+           (pet.hunger < _p.hungryBelow)                   << 1  |
+           (pet.happiness > _p.happyAbove)                 << 2  |
+           (pet.happiness > _p.excitedAbove)               << 3  |
+           (wifi.netCount > 0)                             << 4  |
+           (wifi.netCount > _p.excitedNetsAbove)           << 5  |
+           (wifi.hiddenCount > 0 || wifi.openCount > 0)    << 6  |
+           (quiet && t >= _boredAt)                        << 7  |
+           (quiet && state.scanned && t >= _sickAt)        << 8;
+}
+
+void PetSim::updateMood(TimeMs t) {
+    uint16_t key = moodKey(t);
+    if (key == _moodKey) {
+        state.mood = _moodFor;
+        _evals.moodSaved++;
+        return;
+    }
+    _moodKey = key;
+    _evals.moodRuns++;
+
+    const Pet&       pet  = state.pet;
+    const WifiStats& wifi = state.wifi;
+
+    if (pet.health < _p.sickBelow || (wifi.netCount == 0 && state.scanned &&
+                                      t - state.lastScanMs > _p.wifiSickMs)) {
+        state.mood = MOOD_SICK;
+    } else if (pet.hunger < _p.hungryBelow) {
+        state.mood = MOOD_HUNGRY;
+    } else if (pet.happiness > _p.excitedAbove && wifi.netCount > _p.excitedNetsAbove) {
+        state.mood = MOOD_EXCITED;
+    } else if (pet.happiness > _p.happyAbove && wifi.netCount > 0) {
+        state.mood = MOOD_HAPPY;
+    } else if (wifi.netCount == 0 && t - state.lastScanMs > _p.wifiBoredMs) {
+        state.mood = MOOD_BORED;
+    } else if (wifi.hiddenCount > 0 || wifi.openCount > 0) {
+        state.mood = MOOD_CURIOUS;
+    } else {
+        state.mood = MOOD_CALM;
+    }
+    _moodFor = state.mood;
+}
+
+// The stage, and which side of each age and wellbeing step the pet is on
+uint16_t PetSim::evolveKey() const {
+    const Pet& pet = state.pet;
+    unsigned long a = pet.ageMinutes;
+    int avg = (pet.hunger + pet.happiness + pet.health) / 3;
+
+    return state.stage                                                |
+           (a >= (unsigned long)_p.teenAge)  << 2 | (avg > _p.teenWellbeing)  << 3 |
+           (a >= (unsigned long)_p.adultAge) << 4 | (avg > _p.adultWellbeing) << 5 |
+           (a >= (unsigned long)_p.elderAge) << 6 | (avg > _p.elderWellbeing) << 7;
+}
+
+// The key is kept as it stands after the rules ran: the stage they left
+// the pet at, where the same steps give nothing more
+void PetSim::updateEvolution(TimeMs t) {
+    if (evolveKey() == _evolveKey) {
+        _evals.evolveSaved++;
+        return;
+    }
+    _evals.evolveRuns++;
+
+    const Pet& pet = state.pet;
+    unsigned long a = pet.ageMinutes;
+    int avg = (pet.hunger + pet.happiness + pet.health) / 3;
+
+    Stage next = state.stage;
+    if (a >= (unsigned long)_p.elderAge && avg > _p.elderWellbeing && state.stage < STAGE_ELDER)
+        next = STAGE_ELDER;
+    else if (a >= (unsigned long)_p.adultAge && avg > _p.adultWellbeing && state.stage < STAGE_ADULT)
+        next = STAGE_ADULT;
+    else if (a >= (unsigned long)_p.teenAge && avg > _p.teenWellbeing && state.stage < STAGE_TEEN)
+        next = STAGE_TEEN;
+
+    if (next != state.stage) {
+        state.stage = next;
+        emit(EV_EVOLVED, t, next);
+    }
+    _evolveKey = evolveKey();
+}
+
+// ---- autonomous decisions ----
+
+// What the pet weighs when it decides for itself, as data: each activity
+// a sum of terms over the inputs, halved without networks, moved by the
+// mood. Idle is listed first and wins ties, then hunt, discover, rest.
+void PetSim::buildCatalogue() {
+    UtilityEngine& u = _utility;
+    u.clear();
+
+    uint8_t inverse = u.addCurve({ UTIL_LINEAR, -1, 1, 100 });     // 100 - x
+    uint8_t linear  = u.addCurve({ UTIL_LINEAR, 1, 1, 0 });
+    uint8_t half    = u.addCurve({ UTIL_LINEAR, 1, 2, 0 });
+    uint8_t hungry  = u.addCurve({ UTIL_STEP, _p.restHungryBelow, -_p.restHungryPenalty, 0 });
+    uint8_t noNets  = u.addGate({ UTIL_STEP, 1, UTIL_ONE / 2, UTIL_ONE });
+
+    const int32_t W = UTIL_ONE;
+
+    UtilAction idle = { "idle", ACT_NONE, (int16_t)_p.desireIdle };
+
+    UtilAction hunt = { "hunt", ACT_HUNT, 0, 2,
+                        { { IN_HUNGER, inverse, W }, { IN_CURIOSITY, half, W } },
+                        IN_NETS, noNets };
+    hunt.context[MOOD_HUNGRY]  = _p.hungryHuntBonus;
+    hunt.context[MOOD_EXCITED] = _p.restlessHuntBonus;
+    hunt.context[MOOD_BORED]   = _p.restlessHuntBonus;
+
+    UtilAction discover = { "discover", ACT_DISCOVER, 0, 5,
+                            { { IN_CURIOSITY, linear, W },
+                              { IN_HIDDEN,    linear, _p.desireDiscPerHidden * W },
+                              { IN_OPEN,      linear, _p.desireDiscPerOpen * W },
+                              { IN_NETS,      linear, _p.desireDiscPerNet * W },
+                              { IN_JITTER,    linear, W } },
+                            IN_NETS, noNets };
+    discover.context[MOOD_CURIOUS] = _p.curiousDiscBonus;
+    discover.context[MOOD_SICK]    = -_p.sickDiscPenalty;
+    discover.context[MOOD_EXCITED] = _p.restlessDiscBonus;
+    discover.context[MOOD_BORED]   = _p.restlessDiscBonus;
+
+    UtilAction rest = { "rest", ACT_REST, 0, 3,
+                        { { IN_HEALTH, inverse, W }, { IN_STRESS, half, W }, { IN_HUNGER, hungry, W } } };
+    rest.context[MOOD_HUNGRY] = -_p.hungryRestPenalty;
+    rest.context[MOOD_SICK]   = _p.sickRestBonus;
+
+    u.addAction(idle);
+    u.addAction(hunt);
+    u.addAction(discover);
+    u.addAction(rest);
+}
+
+void PetSim::decide(TimeMs t) {
+    if (!_decisionDue) return;
+
+    _decisionDue = false;
+    start(RULE_DECISION, t + rand(PET_STREAM_DECISION, _p.decisionMinMs, _p.decisionMaxMs));
+
+    const Pet&       pet  = state.pet;
+    const WifiStats& wifi = state.wifi;
+
+    uint8_t in[UTIL_MAX_INPUTS] = {};
+    in[IN_HUNGER]    = saturate(pet.hunger);
+    in[IN_HAPPINESS] = saturate(pet.happiness);
+    in[IN_HEALTH]    = saturate(pet.health);
+    in[IN_CURIOSITY] = state.traitCuriosity;
+    in[IN_ACTIVITY]  = state.traitActivity;
+    in[IN_STRESS]    = state.traitStress;
+    in[IN_NETS]      = saturate(wifi.netCount);
+    in[IN_STRONG]    = saturate(wifi.strongCount);
+    in[IN_HIDDEN]    = saturate(wifi.hiddenCount);
+    in[IN_OPEN]      = saturate(wifi.openCount);
+    in[IN_SIGNAL]    = saturate(wifi.avgRSSI + 100);
+    in[IN_JITTER]    = saturate(rand(PET_STREAM_DECISION, 0, _p.desireDiscJitter));
+
+    Activity chosen = ACT_NONE;
+    if (_utility.actions()) chosen = (Activity)_utility.action(_utility.choose(in, state.mood)).outcome;
+    if (_decisionFn) explain(in, t);
+
+    if (chosen == ACT_HUNT || chosen == ACT_DISCOVER) {
+        state.activity = chosen;
+        emit(EV_SCAN_STARTED, t);
+    } else if (chosen == ACT_REST) {
+        state.activity       = ACT_REST;
+        state.restPhase      = REST_ENTER;
+        state.restFrameIndex = 4;                       // start from egg_hatch_5
+        start(RULE_REST, t + REST_ENTER_DELAY, REST_ENTER_DELAY);
+        _restPhaseStart   = t;
+        _restDurationMs   = rand(PET_STREAM_REST, _p.restMinMs, _p.restMaxMs);
+        _restStatsApplied = false;
+        emit(EV_REST_STARTED, t);
+    }
+}
+
+// Scored again with the trace on, off the path of every other decision
+void PetSim::explain(const uint8_t* input, TimeMs t) const {
+    UtilTrace why;
+    _utility.choose(input, state.mood, &why);
+    _decisionFn(_decisionCtx, why, t);
+}
+
+// ---- rest state machine ----
+// Every REST_ENTER_DELAY / REST_WAKE_DELAY while the egg closes or opens;
+// while deep asleep at the halfway mark (stats) and at the end.
+void PetSim::stepRest(TimeMs t) {
+    if (state.activity != ACT_REST || state.restPhase == REST_NONE) {
+        stop(RULE_REST);
+        return;
+    }
+
+    switch (state.restPhase) {
+        case REST_ENTER:
+            // Going to sleep: egg_hatch_5 -> 4 -> 3 -> 2 -> 1
+            if (state.restFrameIndex > 0) {
+                state.restFrameIndex--;
+            } else {
+                state.restFrameIndex = 0;
+                state.restPhase      = REST_DEEP;
+                _restPhaseStart      = t;
+                _restStatsApplied    = false;
+                emit(EV_ASLEEP, t);
+                stepRest(t);                   // plan the deep sleep now, not on a second fire at t
+            }
+            break;
+
+        case REST_DEEP:
+            if (!_restStatsApplied && t - _restPhaseStart > _restDurationMs / 2) {
+                Pet& pet = state.pet;
+                pet.hunger    = clampStat(pet.hunger + _p.restHunger);
+                pet.happiness = clampStat(pet.happiness + _p.restHappiness);
+                pet.health    = clampStat(pet.health + _p.restHealth);
+                _restStatsApplied = true;
+            }
+
+            if (t - _restPhaseStart >= _restDurationMs) {
+                state.restPhase      = REST_WAKE;
+                state.restFrameIndex = 0;              // start from egg_hatch_1
+                _restPhaseStart      = t;
+                start(RULE_REST, t + REST_WAKE_DELAY, REST_WAKE_DELAY);
+                emit(EV_REST_ENDED, t);
+            } else if (!_restStatsApplied) {
+                start(RULE_REST, _restPhaseStart + _restDurationMs / 2 + 1);
+            } else {
+                start(RULE_REST, _restPhaseStart + _restDurationMs);
+            }
+            break;
+
+        case REST_WAKE:
+            // Waking: egg_hatch_1 -> 2 -> 3 -> 4 -> 5
+            if (state.restFrameIndex < 4) {
+                state.restFrameIndex++;
+            } else {
+                state.restFrameIndex = 4;
+                state.restPhase      = REST_NONE;
+                state.activity       = ACT_NONE;
+                stop(RULE_REST);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+// ---- WiFi-based activities ----
+
+void PetSim::scanDone(TimeMs now, const WifiStats& result) {
+    advance(now);
+    state.wifi       = result;
+    state.lastScanMs = now;
+    state.scanned    = true;
+
+    if (state.activity == ACT_HUNT)          resolveHunt(now);
+    else if (state.activity == ACT_DISCOVER) resolveDiscover(now);
+    else return;
+
+    state.activity = ACT_NONE;
+    emit(EV_ACTIVITY_ENDED, now);
+}
+
+void PetSim::resolveHunt(TimeMs t) {
+    const WifiStats& wifi = state.wifi;
+    int hungerDelta = 0;
+    int happyDelta  = 0;
+    int healthDelta = 0;
+
+    if (wifi.netCount == 0) {
+        hungerDelta = _p.huntEmptyHunger;
+        happyDelta  = _p.huntEmptyHappiness;
+        healthDelta = _p.huntEmptyHealth;
+    } else {
+        hungerDelta = wifi.netCount * _p.huntHungerPerNet + wifi.strongCount * _p.huntHungerPerStrong;
+        if (hungerDelta > _p.huntHungerMax) hungerDelta = _p.huntHungerMax;
+
+        int varietyScore = wifi.hiddenCount * 2 + wifi.openCount;
+        happyDelta = varietyScore * _p.huntHappyPerVariety + (wifi.avgRSSI + 100) / 3;
+        if (happyDelta > _p.huntHappyMax) happyDelta = _p.huntHappyMax;
+
+        if (wifi.avgRSSI > _p.huntFairRssi) healthDelta += _p.huntRssiHealth;
+        if (wifi.avgRSSI > _p.huntGoodRssi) healthDelta += _p.huntRssiHealth;
+        if (wifi.strongCount > _p.huntStrongOver) healthDelta += _p.huntStrongHealth;
+    }
+    emit(EV_FED, t, wifi.netCount > 0);
+
+    Pet& pet = state.pet;
+    pet.hunger    = clampStat(pet.hunger + hungerDelta);
+    pet.happiness = clampStat(pet.happiness + happyDelta);
+    pet.health    = clampStat(pet.health + healthDelta);
+
+    state.hungerEffectActive = true;
+    state.hungerEffectFrame  = 0;
+    start(RULE_HUNGER_FX, t + HUNGER_EFFECT_DELAY, HUNGER_EFFECT_DELAY);
+}
+
+void PetSim::resolveDiscover(TimeMs t) {
+    const WifiStats& wifi = state.wifi;
+    int happyDelta  = 0;
+    int hungerDelta = 0;
+
+    if (wifi.netCount == 0) {
+        happyDelta  = _p.discEmptyHappiness;
+        hungerDelta = _p.discEmptyHunger;
+    } else {
+        int curiosity = wifi.hiddenCount * _p.discPerHidden + wifi.openCount * _p.discPerOpen +
+                        wifi.netCount * _p.discPerNet;
+        happyDelta  = curiosity / 2;
+        if (happyDelta > _p.discHappyMax) happyDelta = _p.discHappyMax;
+        hungerDelta = _p.discHunger;
+    }
+    emit(EV_DISCOVERED, t, wifi.netCount > 0);
+
+    Pet& pet = state.pet;
+    pet.happiness = clampStat(pet.happiness + happyDelta);
+    pet.hunger    = clampStat(pet.hunger + hungerDelta);
+}
+
+// ---- time spent switched off ----
+
+// The pet went on living for offlineMs until now but, with the device
+// off, did nothing by itself: one closed-form jump however long it was.
+// Nothing was scanned while off, so the air has been quiet since the
+// device went off, not since this boot
+void PetSim::catchUp(TimeMs now, TimeMs offlineMs) {
+    if (offlineMs <= 0) return;
+
+    bool ticking    = _ticking;
+    bool autonomous = _autonomous;
+    _ticking    = true;
+    _autonomous = false;
+
+    state.lastScanMs = now - offlineMs;
+    startDecay(now - offlineMs);
+    advance(now);
+
+    _ticking    = ticking;
+    _autonomous = autonomous;
+}
+
+// ---- reset ----
+
+void PetSim::reset(TimeMs now, bool full) {
+    advance(now);
+    Pet& pet = state.pet;
+    pet.hunger    = 70;
+    pet.happiness = 70;
+    pet.health    = 70;
+    if (full) {
+        pet.ageMinutes = 0;
+        state.stage    = STAGE_BABY;
+    }
+
+    state.wifi               = WifiStats();
+    state.lastScanMs         = 0;
+    state.scanned            = false;
+    state.activity           = ACT_NONE;
+    state.restPhase          = REST_NONE;
+    state.hungerEffectActive = false;
+    state.dead               = false;
+
+    stop(RULE_REST);
+    stop(RULE_HUNGER_FX);
+    startDecay(now);
+    emit(EV_RESET, now);
+}
+
+// ---- services ----
+
+int32_t PetSim::rand(PetStream s, int32_t lo, int32_t hi) {
+    return _rng[s].range(lo, hi);
+}
+
+void PetSim::emit(PetEventType type, TimeMs at, uint8_t arg) {
+    if (_sink) _sink(_sinkCtx, type, arg, at);
+}
@@ -0,0 +1,268 @@
+#pragma once
+#include <stdint.h>
+#include "pet_rng.h"
+#include "pet_params.h"
+#include "pet_utility.h"
+
+// ============ Pet simulation ============
+//
+// Every rule of the pet's life: decay, ageing, mood, evolution, death,
+// autonomous decisions, rest and what a WiFi hunt or discovery yields.
+// None of it reads a clock, a pin or the radio. Time only moves when
+// advance() is called, randomness comes from streams seeded in begin(), scan
+// results are handed in by whoever ran the scan, and what happened goes
+// out as PetEvents through an injected sink.
+//
+// It needs nothing but <stdint.h>, so the firmware and a host tool run the
+// same rules; on the host a pet's whole life takes milliseconds.
+//
+// Decay and ageing are not stepped. Between two events each stat is a
+// piecewise-linear function of time (so many points per period, a faster
+// rate once the air has been quiet or the pet is starving), and its value
+// at any instant is worked out in O(1) on demand. advance() only stops
+// where something can happen: a timed rule (decision, rest, overlay) or a
+// stat crossing a threshold that changes the mood, kills the pet or lets
+// it evolve. Everything due at the same instant is followed by one
+// evaluation of mood, evolution, death and decisions, as when the
+// firmware woke for it, so the result depends only on the seed, the scan
+// results and the times they were handed in, not on how often or how far
+// apart advance() is called.
+//
+// Inputs set between two calls (setTicking(), a write to state) take
+// effect from the earlier one.
+
+typedef int64_t TimeMs;     // as monotonic.h
+
+#define PET_NEVER   INT64_MAX
+
+enum Activity {
+  ACT_NONE,
+  ACT_HUNT,
+  ACT_DISCOVER,
+  ACT_REST
+};
+
+enum Stage {
+  STAGE_BABY = 0,
+  STAGE_TEEN = 1,
+  STAGE_ADULT = 2,
+  STAGE_ELDER = 3
+};
+
+enum Mood {
+  MOOD_HUNGRY,
+  MOOD_HAPPY,
+  MOOD_CURIOUS,
+  MOOD_BORED,
+  MOOD_SICK,
+  MOOD_EXCITED,
+  MOOD_CALM
+};
+
+enum RestPhase {
+  REST_NONE,
+  REST_ENTER,
+  REST_DEEP,
+  REST_WAKE
+};
+
+struct Pet {
+  int hunger;
+  int happiness;
+  int health;
+
+  unsigned long ageMinutes;
+  unsigned long ageHours;
+  unsigned long ageDays;
+};
+
+struct WifiStats {
+  int netCount    = 0;
+  int strongCount = 0;
+  int hiddenCount = 0;
+  int avgRSSI     = -100;
+  int openCount   = 0;
+  int wpaCount    = 0;
+};
+
+// Outcomes; carried to sound, LEDs and UI by event_bus.h
+enum PetEventType : uint8_t {
+  EV_CLICK,             // a button press was acted on (published by the sketch)
+  EV_FED,               // hunt resolved; arg: 1 = networks found, 0 = none
+  EV_DISCOVERED,        // discovery resolved; arg as EV_FED
+  EV_SCAN_STARTED,      // hunt or discovery began: the environment scans
+  EV_ACTIVITY_ENDED,    // hunt or discovery over
+  EV_FEED_EFFECT_ENDED, // hunger overlay finished
+  EV_REST_STARTED,
+  EV_ASLEEP,            // rest reached deep sleep
+  EV_REST_ENDED,
+  EV_EVOLVED,           // arg: new Stage
+  EV_DIED,
+  EV_HATCH_STARTED,     // published by the sketch
+  EV_RESET,
+  EV_TYPE_COUNT
+};
+
+struct PetState {
+  Pet       pet                = { 70, 70, 70, 0, 0, 0 };
+  Stage     stage              = STAGE_BABY;
+  Mood      mood               = MOOD_CALM;
+  Activity  activity           = ACT_NONE;
+  RestPhase restPhase          = REST_NONE;
+  int       restFrameIndex     = 0;
+  bool      hungerEffectActive = false;
+  int       hungerEffectFrame  = 0;
+  bool      dead               = false;
+
+  WifiStats wifi;
+  TimeMs    lastScanMs         = 0;      // the air is quiet from here; catchUp(): when the device went off
+  bool      scanned            = false;  // a scan has finished since boot: quiet air can sicken
+
+  uint8_t   traitCuriosity     = 70;
+  uint8_t   traitActivity      = 60;
+  uint8_t   traitStress        = 40;
+};
+
+typedef void    (*PetEventFn)(void* ctx, PetEventType type, uint8_t arg, TimeMs at);
+
+// What an autonomous decision scores its catalogue on (pet_utility.h),
+// each saturated to 0 .. 255; the mood is the context
+enum PetInput : uint8_t {
+  IN_HUNGER,
+  IN_HAPPINESS,
+  IN_HEALTH,
+  IN_CURIOSITY,
+  IN_ACTIVITY,
+  IN_STRESS,
+  IN_NETS,
+  IN_STRONG,
+  IN_HIDDEN,
+  IN_OPEN,
+  IN_SIGNAL,        // avgRSSI + 100
+  IN_JITTER,        // 0 .. desireDiscJitter - 1, drawn for each decision
+  IN_COUNT
+};
+
+typedef void    (*PetDecisionFn)(void* ctx, const UtilTrace& why, TimeMs at);
+
+// How often mood and evolution were worked out, and how often the inputs
+// were found on the same side of every threshold as last time, so the
+// last answer stood
+struct PetEvalStats {
+  uint32_t moodRuns    = 0;
+  uint32_t moodSaved   = 0;
+  uint32_t evolveRuns  = 0;
+  uint32_t evolveSaved = 0;
+};
+
+class PetSim {
+public:
+  PetState state;     // read freely; written directly only to restore it
+
+  void   setParams(const PetParams& p);          // before begin()
+  void   begin(TimeMs now, uint32_t seed = 1);   // timers count from now, streams from seed
+  void   setEventSink(PetEventFn fn, void* ctx);
+  void   setDecisionTrace(PetDecisionFn fn, void* ctx);   // why each decision went its way; nullptr: off
+
+  void   setTicking(bool on);      // hatched and shown: decay and the rules run
+  void   setAutonomous(bool on);   // on HOME: may start activities by itself
+
+  void   advance(TimeMs now);      // run everything due by now, in time order
+  void   scanDone(TimeMs now, const WifiStats& result);   // a failed scan: WifiStats()
+  void   reset(TimeMs now, bool full);
+  void   catchUp(TimeMs now, TimeMs offlineMs);   // state as saved offlineMs before now
+
+  TimeMs nextDue(TimeMs now) const;   // when advance() next has work; PET_NEVER if idle
+  TimeMs nextStatChange() const;      // next decay or ageing step, for a screen showing them
+
+  const PetParams&    params() const    { return _p; }
+  UtilityEngine&      utility()         { return _utility; }   // the catalogue begin() built; add to it after
+  const PetEvalStats& evalStats() const { return _evals; }
+
+private:
+  enum Rule : uint8_t {
+    RULE_DECISION,
+    RULE_REST,
+    RULE_HUNGER_FX,
+    RULE_COUNT
+  };
+
+  enum Stat : uint8_t {
+    STAT_HUNGER,
+    STAT_HAPPINESS,
+    STAT_HEALTH,
+    STAT_AGE,
+    STAT_COUNT
+  };
+
+  // A stat from the anchor on: `early` points per tick until `switchAt`,
+  // `late` from then on, never below 0
+  struct DecayLine {
+    int      value;
+    TimeMs   next;         // first tick after the anchor
+    uint32_t period;
+    int      early, late;
+    TimeMs   switchAt;     // first tick time charged `late`
+  };
+
+  PetParams     _p;
+  UtilityEngine _utility;
+
+  TimeMs      _due[RULE_COUNT];
+  uint32_t    _period[RULE_COUNT];
+
+  TimeMs      _statAt = 0;              // state.pet holds the stats at this time
+  TimeMs      _tick[STAT_COUNT];        // each stat's first tick after _statAt
+
+  bool        _ticking     = false;
+  bool        _autonomous  = false;
+  bool        _decisionDue = false;
+
+  TimeMs      _restPhaseStart   = 0;
+  uint32_t    _restDurationMs   = 0;
+  bool        _restStatsApplied = false;
+
+  Pcg32       _rng[PET_STREAM_REST + 1];   // the streams the rules draw from
+
+  // Mood and evolution are worked out again only when an input they test
+  // has crossed one of their thresholds (moodKey(), evolveKey())
+  uint16_t     _moodKey   = UINT16_MAX;
+  Mood         _moodFor   = MOOD_CALM;       // the mood _moodKey gives
+  uint16_t     _evolveKey = UINT16_MAX;
+  TimeMs       _airFrom   = -1;              // lastScanMs the two below count from
+  TimeMs       _boredAt   = 0;               // without networks: bored from here,
+  TimeMs       _sickAt    = 0;               // sick from here
+  PetEvalStats _evals;
+  PetEventFn    _sink        = nullptr;
+  void*         _sinkCtx     = nullptr;
+  PetDecisionFn _decisionFn  = nullptr;
+  void*         _decisionCtx = nullptr;
+
+  void    start(Rule r, TimeMs at, uint32_t periodMs = 0);
+  void    stop(Rule r) { _due[r] = PET_NEVER; }
+  void    startDecay(TimeMs now);
+  void    fire(Rule r, TimeMs t);
+  void    tick(TimeMs t);
+
+  DecayLine     line(Stat s) const;
+  static int    valueAt(const DecayLine& d, TimeMs t);
+  static TimeMs whenBelow(const DecayLine& d, int threshold);
+  void          materialize(TimeMs t);
+  TimeMs        nextCrossing() const;
+  TimeMs        nextEvolution() const;
+  uint32_t      period(Stat s) const;
+
+  uint16_t moodKey(TimeMs t);
+  uint16_t evolveKey() const;
+  void    updateMood(TimeMs t);
+  void    updateEvolution(TimeMs t);
+  void    buildCatalogue();
+  void    decide(TimeMs t);
+  void    explain(const uint8_t* input, TimeMs t) const;
+  void    stepRest(TimeMs t);
+  void    resolveHunt(TimeMs t);
+  void    resolveDiscover(TimeMs t);
+
+  int32_t rand(PetStream s, int32_t lo, int32_t hi);
+  void    emit(PetEventType type, TimeMs at, uint8_t arg = 0);
+};
@@ -0,0 +1,98 @@
+#include "pet_utility.h"
+#include <math.h>
+
+void UtilityEngine::clear() {
+    _curves  = 0;
+    _actions = 0;
+}
+
+// ---- tables ----
+// Worked out once per curve, with floats where the shape needs them;
+// scoring only reads them
+
+static int32_t curveAt(const UtilCurve& c, int x, int32_t scale) {
+    switch (c.shape) {
+        case UTIL_LINEAR:
+            return (c.b ? c.a * x / c.b + c.c : c.c) * scale;
+        case UTIL_STEP:
+            return (x < c.a ? c.b : c.c) * scale;
+        case UTIL_LOGISTIC: {
+            float y = c.c / (1.0f + expf(-(x - c.a) / (float)(c.b ? c.b : 1)));
+            return (int32_t)lroundf(y * scale);
+        }
+        default:
+            return 0;
+    }
+}
+
+static int addTable(int16_t (*lut)[UTIL_LUT_SIZE], uint8_t& count, const UtilCurve& c, int32_t scale) {
+    if (count >= UTIL_MAX_CURVES) return -1;
+    int16_t* t = lut[count];
+    for (int x = 0; x < UTIL_LUT_SIZE; x++) {
+        int32_t y = curveAt(c, x, scale);
+        t[x] = (int16_t)(y < INT16_MIN ? INT16_MIN : y > INT16_MAX ? INT16_MAX : y);
+    }
+    return count++;
+}
+
+int UtilityEngine::addCurve(const UtilCurve& c) {
+    return addTable(_lut, _curves, c, 1 << UTIL_CURVE_SHIFT);
+}
+
+int UtilityEngine::addGate(const UtilCurve& c) {
+    return addTable(_lut, _curves, c, 1);
+}
+
+int UtilityEngine::addAction(const UtilAction& a) {
+    if (_actions >= UTIL_MAX_ACTIONS) return -1;
+    _action[_actions] = a;
+    return _actions++;
+}
+
+// ---- scoring ----
+
+int UtilityEngine::choose(const uint8_t input[UTIL_MAX_INPUTS], uint8_t context, UtilTrace* trace) const {
+    const int POINT_SHIFT = 8 + UTIL_CURVE_SHIFT;     // Q8 weight times Q4 table
+
+    int     best      = 0;
+    int32_t bestScore = INT32_MIN;
+    for (int i = 0; i < _actions; i++) {
+        const UtilAction& a = _action[i];
+
+        // A table entry times a weight the parameters allow can pass 2^30,
+        // and an action sums up to six: 64 bits hold any sum, which is
+        // clamped to 32 before the gate scales it
+        int64_t sum = 0;
+        for (int k = 0; k < a.terms; k++) {
+            const UtilTerm& t = a.term[k];
+            int64_t v = (int64_t)_lut[t.curve][input[t.input]] * t.weight;
+            sum += v;
+            if (trace) trace->term[i][k] = v;
+        }
+        if (sum > INT32_MAX) sum = INT32_MAX;
+        if (sum < INT32_MIN) sum = INT32_MIN;
+
+        int32_t gate = a.gateCurve == UTIL_NO_GATE ? UTIL_ONE : _lut[a.gateCurve][input[a.gateInput]];
+        if (gate != UTIL_ONE) sum = (sum * gate) >> 8;
+
+        int32_t score = (int32_t)(sum >> POINT_SHIFT) + a.base + a.context[context];
+        if (score < 0) score = 0;
+
+        if (trace) {
+            trace->gate[i]  = gate;
+            trace->score[i] = score;
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            best      = i;
+        }
+    }
+
+    if (trace) {
+        for (int n = 0; n < UTIL_MAX_INPUTS; n++) trace->input[n] = input[n];
+        trace->context = context;
+        trace->actions = _actions;
+        trace->chosen  = best;
+    }
+    return best;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <stdint.h>
+
+// ============ Utility scoring ============
+//
+// Picks one action out of a catalogue by scoring each against the same
+// inputs. An action is a list of terms, each an input run through a
+// response curve and scaled by a weight, summed; then optionally
+// multiplied by a gate curve (0.5 while something is missing, say), then
+// given points for the current context (the pet's mood) and floored at
+// zero. The highest score wins; on a tie the action listed first.
+//
+// Curves are described once (linear, step, logistic) and precomputed
+// into lookup tables over every input value, so scoring is table reads,
+// multiplies and adds in fixed point: no floats, no division, nothing
+// allocated. Inputs are 0 .. 255; callers saturate them.
+//
+//   curve tables  Q4 points       (1/16 point, about +-2047 points)
+//   weights       Q8              (UTIL_ONE = 1.0)
+//   gates         Q8 multipliers
+//
+// A term whose table holds whole points and whose weight is a whole
+// number scores exactly the integer arithmetic it replaces, rounding
+// down. Terms are summed in 64 bits, so any int32 weight is safe; the sum
+// saturates at +-2^31 in Q12 (+-524288 points) before the gate.
+//
+// With a UtilTrace, choose() also leaves what every term, gate and
+// context bonus contributed to each score, for a tool to say why.
+//
+// Nothing but <stdint.h>, like pet_sim.h.
+
+#define UTIL_MAX_ACTIONS    32
+#define UTIL_MAX_TERMS      6
+#define UTIL_MAX_CURVES     12
+#define UTIL_MAX_INPUTS     16
+#define UTIL_MAX_CONTEXTS   8
+#define UTIL_LUT_SIZE       256
+
+#define UTIL_ONE            256       // weight or gate of 1.0
+#define UTIL_CURVE_SHIFT    4
+#define UTIL_NO_GATE        0xFF
+
+enum UtilShape : uint8_t {
+  UTIL_LINEAR,        // a * x / b + c, as integer division
+  UTIL_STEP,          // x < a ? b : c
+  UTIL_LOGISTIC       // c / (1 + e^-((x - a) / b)): rises around a, over about 4b
+};
+
+struct UtilCurve {
+  UtilShape shape;
+  int32_t   a, b, c;
+};
+
+struct UtilTerm {
+  uint8_t input;
+  uint8_t curve;
+  int32_t weight;     // Q8
+};
+
+struct UtilAction {
+  const char* name;
+  uint8_t     outcome;                          // what the caller does when it wins
+  int16_t     base      = 0;                    // points before any term
+  uint8_t     terms     = 0;
+  UtilTerm    term[UTIL_MAX_TERMS] = {};
+  uint8_t     gateInput = 0;
+  uint8_t     gateCurve = UTIL_NO_GATE;         // table in Q8 multipliers
+  int16_t     context[UTIL_MAX_CONTEXTS] = {};  // points added in each context
+};
+
+// Contributions in Q12 points (UTIL_ONE << UTIL_CURVE_SHIFT per point)
+// except where noted
+struct UtilTrace {
+  uint8_t input[UTIL_MAX_INPUTS];
+  uint8_t context;
+  uint8_t actions;
+  int64_t term[UTIL_MAX_ACTIONS][UTIL_MAX_TERMS];
+  int32_t gate[UTIL_MAX_ACTIONS];           // Q8 multiplier applied
+  int32_t score[UTIL_MAX_ACTIONS];          // whole points, after context and floor
+  uint8_t chosen;
+};
+
+class UtilityEngine {
+public:
+  void clear();
+  int  addCurve(const UtilCurve& c);        // in points, for terms; its index, -1 when full
+  int  addGate(const UtilCurve& c);         // in Q8 multipliers, for gates; as addCurve
+  int  addAction(const UtilAction& a);      // its index; -1 when full
+
+  // Index of the winning action (0 if there are none)
+  int  choose(const uint8_t input[UTIL_MAX_INPUTS], uint8_t context, UtilTrace* trace = nullptr) const;
+
+  int               actions() const         { return _actions; }
+  const UtilAction& action(int i) const     { return _action[i]; }
+
+private:
+  int16_t    _lut[UTIL_MAX_CURVES][UTIL_LUT_SIZE];
+  UtilAction _action[UTIL_MAX_ACTIONS];
+  uint8_t    _curves  = 0;
+  uint8_t    _actions = 0;
+};
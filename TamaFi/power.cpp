@@ -0,0 +1,191 @@
+#include "power.h"
+#include "trace.h"
+#include <atomic>
+
+#ifdef ESP_PLATFORM
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <driver/ledc.h>
+#endif
+
+#define POWER_CPU_MAX_MHZ   240
+#define POWER_CPU_MIN_MHZ   80        // keeps APB at 80 MHz, so SPI and LEDC dividers hold
+
+// ---------------------------------------------------------------------------
+// Accounting
+// ---------------------------------------------------------------------------
+// Counters are written by one task each and read by the other, so they are
+// whole milliseconds in 32-bit atomics; the sub-millisecond remainders stay
+// with the writer.
+
+struct ScreenCounters {
+    std::atomic<uint32_t> spanMs{0};
+    std::atomic<uint32_t> busyMs[POWER_DOMAINS];
+    std::atomic<uint32_t> wakes[POWER_DOMAINS];
+};
+static ScreenCounters counters[SCREEN_COUNT];
+
+struct DomainClock {
+    TimeUs   wokeUs = 0;          // start of the current busy stretch
+    uint32_t fracUs = 0;
+};
+static DomainClock domains[POWER_DOMAINS];
+
+// Time on show, kept by the logic task
+static Screen   spanScreen = SCREEN_BOOT;
+static TimeUs   spanMarkUs = 0;
+static uint32_t spanFracUs = 0;
+
+static void chargeUs(std::atomic<uint32_t>& ms, uint32_t& fracUs, TimeUs us) {
+    TimeUs total = fracUs + us;
+    if (total >= 1000) ms.fetch_add((uint32_t)(total / 1000), std::memory_order_relaxed);
+    fracUs = (uint32_t)(total % 1000);
+}
+
+static void account(PowerDomain d, Screen screen) {
+    if (screen >= SCREEN_COUNT) return;
+    TimeUs now = monoUs();
+
+    chargeUs(counters[screen].busyMs[d], domains[d].fracUs, now - domains[d].wokeUs);
+
+    if (d == POWER_LOGIC) {
+        chargeUs(counters[spanScreen].spanMs, spanFracUs, now - spanMarkUs);
+        spanMarkUs = now;
+        spanScreen = screen;
+    }
+}
+
+static void woke(PowerDomain d, Screen screen) {
+    domains[d].wokeUs = monoUs();
+    if (screen < SCREEN_COUNT)
+        counters[screen].wakes[d].fetch_add(1, std::memory_order_relaxed);
+}
+
+PowerReport powerReport(Screen s) {
+    PowerReport r = {};
+    if (s >= SCREEN_COUNT) return r;
+    r.spanMs = counters[s].spanMs.load(std::memory_order_relaxed);
+    for (int d = 0; d < POWER_DOMAINS; d++) {
+        r.busyMs[d] = counters[s].busyMs[d].load(std::memory_order_relaxed);
+        r.wakes[d]  = counters[s].wakes[d].load(std::memory_order_relaxed);
+    }
+
+    // The counts follow from when the tasks slept, which a replay does not
+    // redo: a trace carries what was read
+    r.spanMs = traceValue(TRACE_ENV, r.spanMs);
+    for (int d = 0; d < POWER_DOMAINS; d++) {
+        r.busyMs[d] = traceValue(TRACE_ENV, r.busyMs[d]);
+        r.wakes[d]  = traceValue(TRACE_ENV, r.wakes[d]);
+    }
+    return r;
+}
+
+#ifdef ESP_PLATFORM
+// ---------------------------------------------------------------------------
+// ESP32-S3: task notifications, PM locks, GPIO wake
+// ---------------------------------------------------------------------------
+static TaskHandle_t         tasks[POWER_DOMAINS];
+static esp_pm_lock_handle_t cpuLocks[POWER_DOMAINS];   // CPU at full speed while busy
+static esp_pm_lock_handle_t noSleepLock;
+static bool                 noSleepHeld     = false;
+static bool                 pmConfigured    = false;
+
+void powerInit() {
+    spanMarkUs = monoUs();
+    for (int d = 0; d < POWER_DOMAINS; d++) domains[d].wokeUs = spanMarkUs;
+
+    esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "logic",  &cpuLocks[POWER_LOGIC]);
+    esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "render", &cpuLocks[POWER_RENDER]);
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "tamafi", &noSleepLock);
+
+    // Both tasks start busy
+    for (int d = 0; d < POWER_DOMAINS; d++)
+        if (cpuLocks[d]) esp_pm_lock_acquire(cpuLocks[d]);
+
+    esp_pm_config_esp32s3_t cfg = {};
+    cfg.max_freq_mhz       = POWER_CPU_MAX_MHZ;
+    cfg.min_freq_mhz       = POWER_CPU_MIN_MHZ;
+    cfg.light_sleep_enable = true;
+    pmConfigured = esp_pm_configure(&cfg) == ESP_OK;
+
+    esp_sleep_enable_gpio_wakeup();       // the button interrupts (buttons.cpp)
+}
+
+bool powerLightSleepAvailable() {
+    return pmConfigured;
+}
+
+// The LEDC timers run from APB, which stops in light sleep. Move the
+// channel's timer (ledcSetup() maps channel n to timer (n/2)%4) onto the
+// 8 MHz RTC oscillator and keep that powered, so the PWM level holds.
+void powerKeepPwmInSleep(uint8_t ledcChannel) {
+    ledc_timer_config_t t = {};
+    t.speed_mode      = LEDC_LOW_SPEED_MODE;
+    t.duty_resolution = LEDC_TIMER_8_BIT;
+    t.timer_num       = (ledc_timer_t)((ledcChannel / 2) % 4);
+    t.freq_hz         = ledcReadFreq(ledcChannel);
+    t.clk_cfg         = LEDC_USE_RTC8M_CLK;
+    if (ledc_timer_config(&t) == ESP_OK)
+        esp_sleep_pd_config(ESP_PD_DOMAIN_RTC8M, ESP_PD_OPTION_ON);
+}
+
+void powerAllowLightSleep(bool allow) {
+    if (!noSleepLock || allow != noSleepHeld) return;
+    if (allow) esp_pm_lock_release(noSleepLock);
+    else       esp_pm_lock_acquire(noSleepLock);
+    noSleepHeld = !allow;
+}
+
+void powerSleep(PowerDomain d, Screen screen, uint32_t ms) {
+    account(d, screen);
+    if (!tasks[d]) tasks[d] = xTaskGetCurrentTaskHandle();
+
+    TickType_t ticks = (ms == NO_DEADLINE) ? portMAX_DELAY : pdMS_TO_TICKS(ms);
+    if (ticks == 0) ticks = 1;                // let this core's idle task run
+
+    if (cpuLocks[d]) esp_pm_lock_release(cpuLocks[d]);
+    ulTaskNotifyTake(pdTRUE, ticks);
+    if (cpuLocks[d]) esp_pm_lock_acquire(cpuLocks[d]);
+
+    woke(d, screen);
+}
+
+void IRAM_ATTR powerKick(PowerDomain d) {
+    TaskHandle_t t = tasks[d];
+    if (!t) return;
+
+    if (xPortInIsrContext()) {
+        BaseType_t higher = pdFALSE;
+        vTaskNotifyGiveFromISR(t, &higher);
+        if (higher) portYIELD_FROM_ISR();
+    } else {
+        xTaskNotifyGive(t);
+    }
+}
+
+#else
+// ---------------------------------------------------------------------------
+// Host: nothing blocks; the simulator advances the clock between steps
+// ---------------------------------------------------------------------------
+static std::atomic<bool> kicks[POWER_DOMAINS];
+
+void powerInit() {
+    spanMarkUs = monoUs();
+    for (int d = 0; d < POWER_DOMAINS; d++) domains[d].wokeUs = spanMarkUs;
+}
+
+bool powerLightSleepAvailable()                       { return false; }
+void powerKeepPwmInSleep(uint8_t)                     {}
+void powerAllowLightSleep(bool)                       {}
+
+void powerSleep(PowerDomain d, Screen screen, uint32_t) {
+    account(d, screen);
+}
+
+void powerWake(PowerDomain d, Screen screen) {
+    woke(d, screen);
+}
+
+void powerKick(PowerDomain d)     { kicks[d].store(true); }
+bool powerTakeKick(PowerDomain d) { return kicks[d].exchange(false); }
+#endif
@@ -0,0 +1,57 @@
+#pragma once
+#include <Arduino.h>
+#include "ui.h"
+#include "monotonic.h"
+
+// ============ Deadline-driven sleep ============
+//
+// The logic and render tasks never poll. After each step a task works out
+// how long it may sleep (the earliest deadline of everything it drives) and
+// blocks in powerSleep() until then, or until something kicks it: a button
+// press (GPIO interrupt), a finished WiFi scan, a new snapshot for the
+// render task, a finished hatch animation for the logic task.
+//
+// With both tasks blocked the FreeRTOS idle hook can put the chip into light
+// sleep until the earliest of the two timeouts. That needs CONFIG_PM_ENABLE
+// and CONFIG_FREERTOS_USE_TICKLESS_IDLE in the ESP-IDF config; the idle hook
+// only sleeps when the gap is at least CONFIG_FREERTOS_IDLE_TIME_BEFORE_SLEEP
+// ticks. Without them the waits still park both cores in WAITI.
+//
+// Every wake and every busy stretch is charged to the screen on show, so
+// the duty cycle and wake-ups per minute can be read per screen.
+
+#define NO_DEADLINE      UINT32_MAX
+#define SCREEN_COUNT     (SCREEN_GAMEOVER + 1)
+
+enum PowerDomain : uint8_t {
+  POWER_LOGIC,
+  POWER_RENDER,
+  POWER_DOMAINS
+};
+
+void powerInit();                                     // setup(), before the tasks start
+void powerKeepPwmInSleep(uint8_t ledcChannel);        // backlight keeps dimming while asleep
+
+// Called from a task: charge the time since the last wake to `screen`, then
+// block for up to `ms` (NO_DEADLINE = until kicked)
+void powerSleep(PowerDomain d, Screen screen, uint32_t ms);
+void powerKick(PowerDomain d);                        // task or ISR context
+
+// Logic side: whether light sleep may be used right now (buzzer playing
+// or Auto Sleep off say no)
+void powerAllowLightSleep(bool allow);
+bool powerLightSleepAvailable();
+
+struct PowerReport {
+  uint32_t spanMs;                    // time the screen was on show
+  uint32_t busyMs[POWER_DOMAINS];
+  uint32_t wakes[POWER_DOMAINS];
+};
+PowerReport powerReport(Screen s);
+
+#ifndef ESP_PLATFORM
+// Host: powerSleep() only does the accounting. The simulator steps time
+// itself, picks up kicks here and says when it resumes a task.
+bool powerTakeKick(PowerDomain d);
+void powerWake(PowerDomain d, Screen screen);
+#endif
@@ -0,0 +1,260 @@
+#pragma once
+#include <stdint.h>
+
+// ============ RGB565 pixel kernels (two pixels per 32-bit word) ============
+//
+// Plain C++ with no Arduino dependency, so the same code runs on the ESP32
+// and on a desktop host.
+//
+// A pair of pixels is loaded into one 32-bit word and split into three lane
+// words (R, G, B). Each lane word holds the channel of both pixels in its two
+// 16-bit halves, with enough headroom that one multiply scales both pixels
+// without carries crossing into the neighbour.
+//
+// `swapped` selects panel byte order (what TFT_eSprite keeps in its buffer
+// after setSwapBytes(true) / drawPixel); pass false for native RGB565 arrays
+// such as the images in background.h.
+//
+// Alpha levels run 0..32 (32 = fully source / unchanged).
+
+#define RGB565_ALPHA_MAX 32
+
+static inline uint32_t rgb565Swap2(uint32_t w) {
+  return ((w & 0x00FF00FFu) << 8) | ((w >> 8) & 0x00FF00FFu);
+}
+
+static inline uint32_t rgb565Load2(const uint16_t* p, bool swapped) {
+  uint32_t w = (uint32_t)p[0] | ((uint32_t)p[1] << 16);
+  return swapped ? rgb565Swap2(w) : w;
+}
+
+static inline void rgb565Store2(uint16_t* p, uint32_t w, bool swapped) {
+  if (swapped) w = rgb565Swap2(w);
+  p[0] = (uint16_t)w;
+  p[1] = (uint16_t)(w >> 16);
+}
+
+static inline uint16_t rgb565Swap1(uint16_t c) {
+  return (uint16_t)((c >> 8) | (c << 8));
+}
+
+// Lane layout: R and B 5 bits, G 6 bits, at bit 0 and bit 16 of their word
+#define RGB565_LANE5 0x001F001Fu
+#define RGB565_LANE6 0x003F003Fu
+
+static inline uint32_t rgb565LaneR(uint32_t w) { return (w >> 11) & RGB565_LANE5; }
+static inline uint32_t rgb565LaneG(uint32_t w) { return (w >> 5)  & RGB565_LANE6; }
+static inline uint32_t rgb565LaneB(uint32_t w) { return  w        & RGB565_LANE5; }
+
+static inline uint32_t rgb565Join(uint32_t r, uint32_t g, uint32_t b) {
+  return (r << 11) | (g << 5) | b;
+}
+
+// Multiply the low lane by a0 and the high lane by a1 (per-pixel factors)
+static inline uint32_t rgb565LaneMul2(uint32_t lane, uint32_t a0, uint32_t a1) {
+  return ((lane * a0) & 0x0000FFFFu) | ((lane * a1) & 0xFFFF0000u);
+}
+
+// (s*a + d*(32-a)) / 32 for one lane word, rounded
+static inline uint32_t rgb565MixLane(uint32_t s, uint32_t d, uint32_t a, uint32_t mask) {
+  return ((s * a + d * (RGB565_ALPHA_MAX - a) + 0x00100010u) >> 5) & mask;
+}
+
+static inline uint32_t rgb565Mix2(uint32_t s, uint32_t d, uint32_t a) {
+  return rgb565Join(rgb565MixLane(rgb565LaneR(s), rgb565LaneR(d), a, RGB565_LANE5),
+                    rgb565MixLane(rgb565LaneG(s), rgb565LaneG(d), a, RGB565_LANE6),
+                    rgb565MixLane(rgb565LaneB(s), rgb565LaneB(d), a, RGB565_LANE5));
+}
+
+// ---------------------------------------------------------------------------
+// dst = src * alpha + dst * (1 - alpha), constant alpha 0..32
+// ---------------------------------------------------------------------------
+static inline void rgb565Blend(uint16_t* dst, const uint16_t* src, uint32_t count,
+                               uint8_t alpha, bool swapped) {
+  uint32_t a = alpha > RGB565_ALPHA_MAX ? RGB565_ALPHA_MAX : alpha;
+
+  uint32_t i = 0;
+  for (; i + 1 < count; i += 2) {
+    uint32_t s = rgb565Load2(src + i, swapped);
+    uint32_t d = rgb565Load2(dst + i, swapped);
+    rgb565Store2(dst + i, rgb565Mix2(s, d, a), swapped);
+  }
+  if (i < count) {
+    uint16_t s = swapped ? rgb565Swap1(src[i]) : src[i];
+    uint16_t d = swapped ? rgb565Swap1(dst[i]) : dst[i];
+    uint16_t o = (uint16_t)rgb565Mix2(s, d, a);
+    dst[i] = swapped ? rgb565Swap1(o) : o;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Translucent solid overlay: dst = color * alpha + dst * (1 - alpha)
+// `color` is native RGB565 regardless of `swapped`.
+// ---------------------------------------------------------------------------
+static inline void rgb565BlendColor(uint16_t* dst, uint32_t count, uint16_t color,
+                                    uint8_t alpha, bool swapped) {
+  uint32_t a  = alpha > RGB565_ALPHA_MAX ? RGB565_ALPHA_MAX : alpha;
+  uint32_t c2 = (uint32_t)color | ((uint32_t)color << 16);
+
+  // Source side of the mix is constant, so pre-multiply it once
+  uint32_t sr = rgb565LaneR(c2) * a + 0x00100010u;
+  uint32_t sg = rgb565LaneG(c2) * a + 0x00100010u;
+  uint32_t sb = rgb565LaneB(c2) * a + 0x00100010u;
+  uint32_t ia = RGB565_ALPHA_MAX - a;
+
+  uint32_t i = 0;
+  for (; i + 1 < count; i += 2) {
+    uint32_t d = rgb565Load2(dst + i, swapped);
+    uint32_t o = rgb565Join(((sr + rgb565LaneR(d) * ia) >> 5) & RGB565_LANE5,
+                            ((sg + rgb565LaneG(d) * ia) >> 5) & RGB565_LANE6,
+                            ((sb + rgb565LaneB(d) * ia) >> 5) & RGB565_LANE5);
+    rgb565Store2(dst + i, o, swapped);
+  }
+  if (i < count) {
+    uint16_t d = swapped ? rgb565Swap1(dst[i]) : dst[i];
+    uint16_t o = (uint16_t)rgb565Mix2(color, d, a);
+    dst[i] = swapped ? rgb565Swap1(o) : o;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Per-pixel 4-bit alpha. alpha4 packs two pixels per byte, low nibble first;
+// nibble 0 keeps dst, 15 takes src.
+// ---------------------------------------------------------------------------
+static inline uint32_t rgb565Alpha4To32(uint32_t a4) {
+  return (a4 * 34 + 8) >> 4;        // 0..15 -> 0..32
+}
+
+static inline void rgb565BlendAlpha4(uint16_t* dst, const uint16_t* src,
+                                     const uint8_t* alpha4, uint32_t count,
+                                     bool swapped) {
+  uint32_t i = 0;
+  for (; i + 1 < count; i += 2) {
+    uint8_t  a  = alpha4[i >> 1];
+    uint32_t a0 = rgb565Alpha4To32(a & 0x0F);
+    uint32_t a1 = rgb565Alpha4To32(a >> 4);
+
+    if ((a0 & a1) == RGB565_ALPHA_MAX) {          // both opaque
+      dst[i] = src[i]; dst[i + 1] = src[i + 1];
+      continue;
+    }
+    if ((a0 | a1) == 0) continue;                 // both transparent
+
+    uint32_t s = rgb565Load2(src + i, swapped);
+    uint32_t d = rgb565Load2(dst + i, swapped);
+    uint32_t i0 = RGB565_ALPHA_MAX - a0;
+    uint32_t i1 = RGB565_ALPHA_MAX - a1;
+
+    uint32_t r = ((rgb565LaneMul2(rgb565LaneR(s), a0, a1) +
+                   rgb565LaneMul2(rgb565LaneR(d), i0, i1) + 0x00100010u) >> 5) & RGB565_LANE5;
+    uint32_t g = ((rgb565LaneMul2(rgb565LaneG(s), a0, a1) +
+                   rgb565LaneMul2(rgb565LaneG(d), i0, i1) + 0x00100010u) >> 5) & RGB565_LANE6;
+    uint32_t b = ((rgb565LaneMul2(rgb565LaneB(s), a0, a1) +
+                   rgb565LaneMul2(rgb565LaneB(d), i0, i1) + 0x00100010u) >> 5) & RGB565_LANE5;
+
+    rgb565Store2(dst + i, rgb565Join(r, g, b), swapped);
+  }
+  if (i < count) {
+    uint32_t a = rgb565Alpha4To32(alpha4[i >> 1] & 0x0F);
+    uint16_t s = swapped ? rgb565Swap1(src[i]) : src[i];
+    uint16_t d = swapped ? rgb565Swap1(dst[i]) : dst[i];
+    uint16_t o = (uint16_t)rgb565Mix2(s, d, a);
+    dst[i] = swapped ? rgb565Swap1(o) : o;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Tint / multiply: each channel scaled by the matching channel of `tint`
+// (native RGB565). White leaves pixels unchanged, black clears them.
+// ---------------------------------------------------------------------------
+static inline void rgb565Tint(uint16_t* dst, uint32_t count, uint16_t tint, bool swapped) {
+  uint32_t tr = ((tint >> 11) & 0x1F) + 1;     // 1..32
+  uint32_t tg = ((tint >> 5)  & 0x3F) + 1;     // 1..64
+  uint32_t tb = ( tint        & 0x1F) + 1;
+
+  uint32_t i = 0;
+  for (; i + 1 < count; i += 2) {
+    uint32_t d = rgb565Load2(dst + i, swapped);
+    uint32_t o = rgb565Join(((rgb565LaneR(d) * tr) >> 5) & RGB565_LANE5,
+                            ((rgb565LaneG(d) * tg) >> 6) & RGB565_LANE6,
+                            ((rgb565LaneB(d) * tb) >> 5) & RGB565_LANE5);
+    rgb565Store2(dst + i, o, swapped);
+  }
+  if (i < count) {
+    uint32_t d = swapped ? rgb565Swap1(dst[i]) : dst[i];
+    uint16_t o = (uint16_t)rgb565Join(((rgb565LaneR(d) * tr) >> 5) & RGB565_LANE5,
+                                      ((rgb565LaneG(d) * tg) >> 6) & RGB565_LANE6,
+                                      ((rgb565LaneB(d) * tb) >> 5) & RGB565_LANE5);
+    dst[i] = swapped ? rgb565Swap1(o) : o;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Brightness scale, level 0..32 (32 = unchanged, 0 = black)
+// ---------------------------------------------------------------------------
+static inline void rgb565Scale(uint16_t* dst, uint32_t count, uint8_t level, bool swapped) {
+  uint32_t l = level > RGB565_ALPHA_MAX ? RGB565_ALPHA_MAX : level;
+
+  uint32_t i = 0;
+  for (; i + 1 < count; i += 2) {
+    uint32_t d = rgb565Load2(dst + i, swapped);
+    uint32_t o = rgb565Join(((rgb565LaneR(d) * l) >> 5) & RGB565_LANE5,
+                            ((rgb565LaneG(d) * l) >> 5) & RGB565_LANE6,
+                            ((rgb565LaneB(d) * l) >> 5) & RGB565_LANE5);
+    rgb565Store2(dst + i, o, swapped);
+  }
+  if (i < count) {
+    uint32_t d = swapped ? rgb565Swap1(dst[i]) : dst[i];
+    uint16_t o = (uint16_t)rgb565Join(((rgb565LaneR(d) * l) >> 5) & RGB565_LANE5,
+                                      ((rgb565LaneG(d) * l) >> 5) & RGB565_LANE6,
+                                      ((rgb565LaneB(d) * l) >> 5) & RGB565_LANE5);
+    dst[i] = swapped ? rgb565Swap1(o) : o;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// 1-bpp mask -> colour. Mask rows are MSB-first (TFT_eSprite 1-bit layout);
+// maskX is the first mask column to use (for clipped draws). Clear bits
+// leave dst untouched.
+// ---------------------------------------------------------------------------
+static inline void rgb565ExpandMask(uint16_t* dst, uint32_t dstStride,
+                                    const uint8_t* mask, uint32_t maskStride,
+                                    uint32_t maskX, uint32_t w, uint32_t h,
+                                    uint16_t color, bool swapped) {
+  uint16_t c = swapped ? rgb565Swap1(color) : color;
+
+  for (uint32_t y = 0; y < h; y++, dst += dstStride, mask += maskStride) {
+    uint32_t x = 0;
+
+    // Leading bits up to a mask byte boundary
+    for (; x < w && ((maskX + x) & 7); x++) {
+      uint32_t mx = maskX + x;
+      if (mask[mx >> 3] & (0x80 >> (mx & 7))) dst[x] = c;
+    }
+
+    // Whole mask bytes: skip empty, fill solid, else test bits
+    for (; x + 8 <= w; x += 8) {
+      uint8_t bits = mask[(maskX + x) >> 3];
+      if (bits == 0) continue;
+      uint16_t* d = dst + x;
+      if (bits == 0xFF) {
+        d[0] = c; d[1] = c; d[2] = c; d[3] = c;
+        d[4] = c; d[5] = c; d[6] = c; d[7] = c;
+        continue;
+      }
+      if (bits & 0x80) d[0] = c;
+      if (bits & 0x40) d[1] = c;
+      if (bits & 0x20) d[2] = c;
+      if (bits & 0x10) d[3] = c;
+      if (bits & 0x08) d[4] = c;
+      if (bits & 0x04) d[5] = c;
+      if (bits & 0x02) d[6] = c;
+      if (bits & 0x01) d[7] = c;
+    }
+
+    for (; x < w; x++) {
+      uint32_t mx = maskX + x;
+      if (mask[mx >> 3] & (0x80 >> (mx & 7))) dst[x] = c;
+    }
+  }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <string.h>
+
+// ============ Single-writer seqlock ============
+//
+// The writer bumps the sequence to odd, copies the value in and bumps it to
+// even again. Readers copy without blocking the writer and retry if the
+// sequence was odd or moved while they were copying, so they only ever see
+// a value from one complete write. T must be trivially copyable.
+
+template <typename T>
+class Seqlock {
+public:
+  void write(const T& v) {
+    uint32_t s = _seq.load(std::memory_order_relaxed);
+    _seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy((void*)&_value, &v, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_release);
+    _seq.store(s + 2, std::memory_order_relaxed);
+  }
+
+  // Returns how many attempts the copy took (1 = no contention); seq is
+  // the sequence() of the write that was copied
+  uint32_t read(T& out, uint32_t& seq) const {
+    for (uint32_t tries = 1;; tries++) {
+      uint32_t s0 = _seq.load(std::memory_order_acquire);
+      if (s0 & 1) continue;
+      memcpy(&out, (const void*)&_value, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (_seq.load(std::memory_order_relaxed) == s0) {
+        seq = s0;
+        return tries;
+      }
+    }
+  }
+
+
+  uint32_t sequence() const { return _seq.load(std::memory_order_acquire); }
+
+private:
+  std::atomic<uint32_t> _seq{0};
+  T                     _value{};
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+// ============ Single-producer / single-consumer ring ============
+//
+// Fixed capacity, no allocation, no locks: the producer only moves the
+// head, the consumer only moves the tail, and each publishes its index
+// with release so the other sees the slot contents first. Safe from an
+// ISR on one core to a task on the other. N must be a power of two; a
+// full ring rejects the push rather than overwrite unread entries.
+
+template <typename T, uint32_t N>
+class SpscRing {
+  static_assert(N && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+  bool push(const T& v) {
+    uint32_t h = _head.load(std::memory_order_relaxed);
+    if (h - _tail.load(std::memory_order_acquire) == N) {
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    _buf[h & (N - 1)] = v;
+    _head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T& out) {
+    uint32_t t = _tail.load(std::memory_order_relaxed);
+    if (t == _head.load(std::memory_order_acquire)) return false;
+    out = _buf[t & (N - 1)];
+    _tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool     empty()   const { return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire); }
+  uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+  T                     _buf[N];
+  std::atomic<uint32_t> _head{0};
+  std::atomic<uint32_t> _tail{0};
+  std::atomic<uint32_t> _dropped{0};
+};
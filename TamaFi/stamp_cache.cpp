@@ -0,0 +1,158 @@
+#include "stamp_cache.h"
+#include "rgb565.h"
+
+extern TFT_eSPI tft;
+
+#define STAMP_MAX         64
+#define STAMP_POOL_BYTES  4096
+#define STAMP_TEXT_MAX    32      // longest cached string + NUL
+#define STAMP_SCRATCH_W   240
+#define STAMP_SCRATCH_H   16
+
+#define STAMP_TEXT_ID     0xFFFF
+
+struct StampEntry {
+    Stamp    stamp;
+    uint32_t hash;
+    uint16_t id;                  // icon id, or STAMP_TEXT_ID
+    uint8_t  font;
+    char     text[STAMP_TEXT_MAX];
+};
+
+static StampEntry entries[STAMP_MAX];
+static int        entryCount = 0;
+
+static uint8_t    pool[STAMP_POOL_BYTES];
+static uint16_t   poolUsed = 0;
+
+// 1-bit canvas every stamp is rasterised on
+static TFT_eSprite scratch(&tft);
+
+static uint32_t hashText(const char* s, uint8_t font) {
+    uint32_t h = 2166136261u ^ font;              // FNV-1a
+    while (*s) { h ^= (uint8_t)*s++; h *= 16777619u; }
+    return h;
+}
+
+void stampInit() {
+    scratch.setColorDepth(1);
+    scratch.createSprite(STAMP_SCRATCH_W, STAMP_SCRATCH_H);
+    stampFlush();
+}
+
+void stampFlush() {
+    entryCount = 0;
+    poolUsed   = 0;
+}
+
+// Copy the top-left w x h of the scratch canvas into the pool
+static const Stamp* captureScratch(StampEntry& e, uint16_t w, uint16_t h) {
+    uint16_t stride = (w + 7) >> 3;
+    uint16_t bytes  = stride * h;
+
+    if (entryCount >= STAMP_MAX || poolUsed + bytes > STAMP_POOL_BYTES) {
+        // Menus only use a few dozen stamps; start over rather than evict
+        stampFlush();
+        if (bytes > STAMP_POOL_BYTES) return nullptr;
+    }
+
+    const uint8_t* src = (const uint8_t*)scratch.getPointer();
+    const uint16_t srcStride = STAMP_SCRATCH_W / 8;
+    uint8_t* dst = pool + poolUsed;
+    for (uint16_t y = 0; y < h; y++)
+        memcpy(dst + y * stride, src + y * srcStride, stride);
+
+    e.stamp.mask   = dst;
+    e.stamp.w      = w;
+    e.stamp.h      = h;
+    e.stamp.stride = stride;
+    poolUsed += bytes;
+
+    entries[entryCount] = e;
+    return &entries[entryCount++].stamp;
+}
+
+const Stamp* stampText(const char* text, uint8_t font) {
+    if (!scratch.created() || strlen(text) >= STAMP_TEXT_MAX) return nullptr;
+
+    uint32_t h = hashText(text, font);
+    for (int i = 0; i < entryCount; i++) {
+        StampEntry& e = entries[i];
+        if (e.hash == h && e.id == STAMP_TEXT_ID && e.font == font &&
+            strcmp(e.text, text) == 0)
+            return &e.stamp;
+    }
+
+    scratch.fillSprite(0);
+    scratch.setTextFont(font);
+    scratch.setTextSize(1);
+    scratch.setTextColor(TFT_WHITE);
+    scratch.setCursor(0, 0);
+    scratch.print(text);
+
+    uint16_t w = min<int>(scratch.textWidth(text), STAMP_SCRATCH_W);
+    uint16_t hgt = min<int>(scratch.fontHeight(), STAMP_SCRATCH_H);
+    if (w == 0) return nullptr;
+
+    StampEntry e;
+    e.hash = h;
+    e.id   = STAMP_TEXT_ID;
+    e.font = font;
+    strcpy(e.text, text);
+    return captureScratch(e, w, hgt);
+}
+
+const Stamp* stampIcon(uint16_t id, uint16_t w, uint16_t h, StampPainter paint, int arg) {
+    if (!scratch.created() || w > STAMP_SCRATCH_W || h > STAMP_SCRATCH_H) return nullptr;
+
+    for (int i = 0; i < entryCount; i++)
+        if (entries[i].id == id) return &entries[i].stamp;
+
+    scratch.fillSprite(0);
+    paint(scratch, arg);
+
+    StampEntry e;
+    e.hash    = id;
+    e.id      = id;
+    e.font    = 0;
+    e.text[0] = 0;
+    return captureScratch(e, w, h);
+}
+
+void stampDraw(TFT_eSprite& dst, const Stamp* s, int x, int y, uint16_t color) {
+    if (!s) return;
+
+    // Viewports set with a datum (transitions) shift and clip everything
+    int ox = dst.getViewportX(), oy = dst.getViewportY();
+    int clipX0 = max(0, ox),             clipY0 = max(0, oy);
+    int clipX1 = min<int>(dst.width(),  ox + dst.getViewportWidth());
+    int clipY1 = min<int>(dst.height(), oy + dst.getViewportHeight());
+
+    x += ox;
+    y += oy;
+
+    int mx = 0, my = 0;
+    int w = s->w, h = s->h;
+    if (x < clipX0) { mx = clipX0 - x; w -= mx; x = clipX0; }
+    if (y < clipY0) { my = clipY0 - y; h -= my; y = clipY0; }
+    if (x + w > clipX1) w = clipX1 - x;
+    if (y + h > clipY1) h = clipY1 - y;
+    if (w <= 0 || h <= 0) return;
+
+    uint16_t* px = (uint16_t*)dst.getPointer() + y * dst.width() + x;
+    rgb565ExpandMask(px, dst.width(), s->mask + my * s->stride, s->stride,
+                     mx, w, h, color, true);
+}
+
+void stampPrint(TFT_eSprite& dst, int x, int y, const char* text, uint16_t color) {
+    const Stamp* s = stampText(text);
+    if (s) {
+        stampDraw(dst, s, x, y, color);
+        return;
+    }
+
+    // Too long (or no scratch canvas): rasterise as before
+    dst.setCursor(x, y);
+    dst.setTextColor(color);
+    dst.print(text);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+
+// ============ Pre-rasterised text runs and icon stamps ============
+//
+// Menu labels and icons never change, so they are rasterised once into
+// 1-bpp masks and afterwards expanded straight into a 16-bit sprite with
+// rgb565ExpandMask(). Colour is applied at draw time, so one mask serves
+// both the normal and the highlighted label.
+
+struct Stamp {
+    const uint8_t* mask;     // MSB-first rows
+    uint16_t       w;
+    uint16_t       h;
+    uint16_t       stride;   // bytes per mask row
+};
+
+// Draws a shape in colour 1 with its top-left at (0,0) of the scratch sprite
+typedef void (*StampPainter)(TFT_eSprite& s, int arg);
+
+void stampInit();                                   // Call once from uiInit()
+void stampFlush();                                  // Drop every cached stamp
+
+const Stamp* stampText(const char* text, uint8_t font = 1);
+const Stamp* stampIcon(uint16_t id, uint16_t w, uint16_t h,
+                       StampPainter paint, int arg);
+
+// Expand a stamp into a 16-bit sprite, honouring its current viewport
+void stampDraw(TFT_eSprite& dst, const Stamp* s, int x, int y, uint16_t color);
+
+// fb.print() equivalent at (x, y) using the cache
+void stampPrint(TFT_eSprite& dst, int x, int y, const char* text, uint16_t color);
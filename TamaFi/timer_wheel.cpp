@@ -0,0 +1,162 @@
+#include "timer_wheel.h"
+#include "power.h"            // NO_DEADLINE
+
+#define WHEEL_MASK   (WHEEL_SLOTS - 1)
+#define WHEEL_SPAN   (1UL << (WHEEL_SLOT_BITS * WHEEL_LEVELS))
+
+struct WheelEntry {
+    TimeMs   expires;
+    uint32_t period;          // 0: one-shot
+    WheelFn  fn;
+    void*    arg;
+    int8_t   next, prev;      // slot list
+    uint8_t  level, slot;
+    bool     armed;
+};
+
+static WheelEntry entries[WHEEL_MAX_TIMERS];
+static int        entryCount = 0;
+
+static int8_t     heads[WHEEL_LEVELS][WHEEL_SLOTS];
+static uint64_t   occupied[WHEEL_LEVELS];        // bit per non-empty slot
+
+static TimeMs     cur = 0;                       // next tick (ms) to process
+
+static inline uint32_t levelShift(int level) {
+    return WHEEL_SLOT_BITS * level;
+}
+
+// File the timer by how far its expiry is from cur (classic Linux layout:
+// level l holds expiries less than 64^(l+1) ticks ahead)
+static void link(int8_t t) {
+    WheelEntry& e = entries[t];
+    TimeMs   delta = e.expires - cur;
+    int      level = 0;
+    uint32_t slot;
+
+    if (delta < 0) {
+        slot = cur & WHEEL_MASK;                 // overdue: next tick
+    } else {
+        if (delta >= (TimeMs)WHEEL_SPAN) delta = WHEEL_SPAN - 1;
+        while (level < WHEEL_LEVELS - 1 && delta >= (TimeMs)(1UL << levelShift(level + 1))) level++;
+        slot = ((cur + delta) >> levelShift(level)) & WHEEL_MASK;
+    }
+
+    e.level = level;
+    e.slot  = slot;
+    e.prev  = -1;
+    e.next  = heads[level][slot];
+    if (e.next >= 0) entries[e.next].prev = t;
+    heads[level][slot] = t;
+    occupied[level] |= 1ULL << slot;
+}
+
+static void unlink(int8_t t) {
+    WheelEntry& e = entries[t];
+    if (e.prev >= 0) entries[e.prev].next = e.next;
+    else             heads[e.level][e.slot] = e.next;
+    if (e.next >= 0) entries[e.next].prev = e.prev;
+    if (heads[e.level][e.slot] < 0) occupied[e.level] &= ~(1ULL << e.slot);
+}
+
+// Re-file the level's current slot one level down; returns its index
+static uint32_t cascade(int level) {
+    uint32_t slot = (cur >> levelShift(level)) & WHEEL_MASK;
+    int8_t   t    = heads[level][slot];
+
+    heads[level][slot] = -1;
+    occupied[level] &= ~(1ULL << slot);
+
+    while (t >= 0) {
+        int8_t next = entries[t].next;
+        link(t);
+        t = next;
+    }
+    return slot;
+}
+
+void wheelInit() {
+    memset(heads, -1, sizeof(heads));
+    memset(occupied, 0, sizeof(occupied));
+    entryCount = 0;
+    cur = monoMs();
+}
+
+WheelTimer wheelCreate(WheelFn fn, void* arg) {
+    if (entryCount >= WHEEL_MAX_TIMERS) return -1;
+    WheelEntry& e = entries[entryCount];
+    e.fn    = fn;
+    e.arg   = arg;
+    e.armed = false;
+    return (WheelTimer)entryCount++;
+}
+
+void wheelStart(WheelTimer t, uint32_t delayMs, uint32_t periodMs) {
+    if (t < 0 || t >= entryCount) return;
+    WheelEntry& e = entries[t];
+    if (e.armed) unlink(t);
+    e.expires = monoMs() + delayMs;
+    e.period  = periodMs;
+    e.armed   = true;
+    link(t);
+}
+
+void wheelStop(WheelTimer t) {
+    if (t < 0 || t >= entryCount || !entries[t].armed) return;
+    unlink(t);
+    entries[t].armed = false;
+}
+
+bool wheelActive(WheelTimer t) {
+    return t >= 0 && t < entryCount && entries[t].armed;
+}
+
+void wheelRun() {
+    TimeMs now = monoMs();
+
+    while (now >= cur) {
+        uint32_t idx = cur & WHEEL_MASK;
+        if (idx == 0) {
+            for (int level = 1; level < WHEEL_LEVELS; level++)
+                if (cascade(level) != 0) break;
+        }
+        cur++;                                   // this tick is now in the past
+
+        while (heads[0][idx] >= 0) {
+            int8_t      t = heads[0][idx];
+            WheelEntry& e = entries[t];
+            unlink(t);
+            e.armed = false;
+
+            // Re-arm before the callback, so it can still stop or restart itself
+            if (e.period) {
+                e.expires += e.period;
+                if (e.expires <= now) e.expires = now + e.period;
+                e.armed = true;
+                link(t);
+            }
+            e.fn(e.arg);
+        }
+
+        // Skip empty level-0 slots, up to the block boundary (cascade) or now
+        if (now < cur) break;
+        uint32_t next = cur & WHEEL_MASK;
+        if (next != 0) {
+            uint64_t ahead = occupied[0] >> next;
+            TimeMs   gap   = ahead ? __builtin_ctzll(ahead) : WHEEL_SLOTS - next;
+            cur += min(gap, now - cur + 1);
+        }
+    }
+}
+
+// Exact earliest expiry rather than the next cascade boundary, so a far
+// timer does not cost extra wake-ups on its way down the levels; wheelRun()
+// does the cascades it passed when it catches up.
+uint32_t wheelIdleMs() {
+    TimeMs   now  = monoMs();
+    uint32_t best = NO_DEADLINE;
+
+    for (int t = 0; t < entryCount; t++)
+        if (entries[t].armed) best = min(best, msUntil(now, entries[t].expires));
+    return best;
+}
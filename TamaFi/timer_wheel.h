@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+#include "monotonic.h"
+
+// ============ Hierarchical timer wheel ============
+//
+// The logic task's device timing (sound steps, the buzzer, LED breathing
+// during rest, autosave, the WiFi scan poll) runs as callbacks registered
+// here once, at setup. The pet's rules (decay, ageing, decisions, rest
+// phases, overlays) keep their own deadlines in PetSim (pet_sim.h).
+// Starting, restarting and stopping a timer are O(1): it is unlinked from
+// / linked into one slot list. Running the wheel costs per slot passed,
+// not per timer, and empty stretches of level 0 are skipped.
+//
+// Four levels of 64 slots at 1 ms cover 2^24 ms (~4.6 h); a later expiry
+// parks in the top level and is re-filed each time its slot comes round.
+// Ticks and expiries are 64-bit monoMs() values, so nothing wraps.
+// A periodic timer is re-armed from its previous expiry, so it does not
+// drift; if it fell a whole period behind it restarts from now instead of
+// firing a burst.
+
+#define WHEEL_MAX_TIMERS   16
+#define WHEEL_LEVELS       4
+#define WHEEL_SLOT_BITS    6
+#define WHEEL_SLOTS        (1 << WHEEL_SLOT_BITS)
+
+typedef int8_t WheelTimer;                  // -1: none
+typedef void (*WheelFn)(void* arg);
+
+void       wheelInit();
+WheelTimer wheelCreate(WheelFn fn, void* arg = nullptr);
+
+// (Re)arm: first expiry after delayMs, then every periodMs (0 = one-shot)
+void       wheelStart(WheelTimer t, uint32_t delayMs, uint32_t periodMs = 0);
+void       wheelStop(WheelTimer t);
+bool       wheelActive(WheelTimer t);
+
+// Fire everything due up to now. Callbacks may start and stop any timer.
+void       wheelRun();
+
+// How long until the earliest armed timer expires; NO_DEADLINE when none is
+uint32_t   wheelIdleMs();
@@ -0,0 +1,510 @@
+#include "trace.h"
+
+#if TAMAFI_TRACE
+#include <atomic>
+
+static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0, "TRACE_BUFFER_SIZE must be a power of two");
+static_assert(TRACE_KINDS <= 16 && TRACE_STREAMS <= 16, "stream and kind share the tag byte");
+
+enum TraceMode : uint8_t { MODE_OFF, MODE_RECORD, MODE_REPLAY };
+
+static volatile TraceMode mode = MODE_OFF;
+
+// Per stream: the last clock read handed out, and whether a live call is
+// under way whose own reads are not inputs (buttonsPoll() under a tap)
+static TimeUs lastUs[TRACE_STREAMS];
+static bool   paused[TRACE_STREAMS];
+
+// ---- encoding ----
+static inline uint8_t  tagOf(int s, TraceKind k) { return (uint8_t)(s << 4 | k); }
+static inline bool     hasValue(TraceKind k)     { return k != TRACE_STEP && k != TRACE_LOST && k != TRACE_END; }
+static inline uint64_t zigzag(int64_t v)         { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static inline int64_t  unzigzag(uint64_t u)      { return (int64_t)(u >> 1) ^ -(int64_t)(u & 1); }
+
+// Frame checksums, a nibble at a time: small table, a few ms a frame on
+// the device
+static uint32_t crc32(const uint8_t* p, size_t n) {
+    static const uint32_t T[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    uint32_t crc = ~0u;
+    while (n--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ T[crc & 15];
+        crc = (crc >> 4) ^ T[crc & 15];
+    }
+    return ~crc;
+}
+
+// ---------------------------------------------------------------------------
+// Which stream is stepping
+// ---------------------------------------------------------------------------
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// The two tasks step at once on their own cores; a read belongs to the
+// stream whose step the calling task is in. ISRs, the WiFi task and the
+// tasks between steps are not traced.
+static TaskHandle_t stepping[TRACE_STREAMS];
+
+static int currentStream() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int s = 0; s < TRACE_STREAMS; s++)
+        if (stepping[s] == self) return paused[s] ? -1 : s;
+    return -1;
+}
+
+static void setStepping(int s, bool on) {
+    stepping[s] = on ? xTaskGetCurrentTaskHandle() : nullptr;
+}
+
+static portMUX_TYPE ringLock = portMUX_INITIALIZER_UNLOCKED;
+#define RING_LOCK()     portENTER_CRITICAL(&ringLock)
+#define RING_UNLOCK()   portEXIT_CRITICAL(&ringLock)
+#else
+static int active = -1;     // host: one thread, one step at a time
+
+static int currentStream() {
+    return (active >= 0 && !paused[active]) ? active : -1;
+}
+
+static void setStepping(int s, bool on) {
+    active = on ? s : -1;
+}
+
+#define RING_LOCK()
+#define RING_UNLOCK()
+#endif
+
+// ---------------------------------------------------------------------------
+// Recording
+// ---------------------------------------------------------------------------
+// Both tasks append under the lock; whichever leaves a step hands what is
+// there to the sink, one at a time.
+static uint8_t          ring[TRACE_BUFFER_SIZE];
+static uint32_t         head = 0, tail = 0;      // appended, sent; both only grow
+static bool             lost = false;
+static std::atomic_flag flushing = ATOMIC_FLAG_INIT;
+static void           (*sinkFn)(const uint8_t*, size_t) = nullptr;
+
+static void put(int s, TraceKind kind, int64_t value = 0) {
+    uint8_t rec[11];
+    size_t  n = 0;
+    rec[n++] = tagOf(s, kind);
+    if (hasValue(kind)) {
+        uint64_t u = zigzag(value);
+        do {
+            rec[n++] = (uint8_t)(u & 0x7F) | (u > 0x7F ? 0x80 : 0);
+            u >>= 7;
+        } while (u);
+    }
+
+    RING_LOCK();
+    if (!lost) {
+        uint32_t room = TRACE_BUFFER_SIZE - (head - tail);
+        if (room < n + 1) {                     // keep one byte to say so
+            ring[head++ & (TRACE_BUFFER_SIZE - 1)] = tagOf(s, TRACE_LOST);
+            lost = true;
+        } else {
+            for (size_t i = 0; i < n; i++) ring[head++ & (TRACE_BUFFER_SIZE - 1)] = rec[i];
+        }
+    }
+    RING_UNLOCK();
+}
+
+static void flush() {
+    if (flushing.test_and_set()) return;        // the other task is at it
+    for (;;) {
+        RING_LOCK();
+        uint32_t from = tail, to = head;
+        RING_UNLOCK();
+        if (from == to) break;
+
+        uint32_t off = from & (TRACE_BUFFER_SIZE - 1);
+        uint32_t n   = min(to - from, (uint32_t)TRACE_BUFFER_SIZE - off);
+        sinkFn(ring + off, n);
+
+        RING_LOCK();
+        tail += n;
+        RING_UNLOCK();
+    }
+    flushing.clear();
+}
+
+static void startRecording(void (*sink)(const uint8_t*, size_t)) {
+    sinkFn = sink;
+    head = tail = 0;
+    lost = false;
+    for (int s = 0; s < TRACE_STREAMS; s++) lastUs[s] = 0;
+
+    const uint8_t header[5] = { TRACE_MAGIC[0], TRACE_MAGIC[1], TRACE_MAGIC[2], TRACE_MAGIC[3], TRACE_VERSION };
+    for (uint8_t b : header) ring[head++] = b;
+    mode = MODE_RECORD;
+}
+
+// ---------------------------------------------------------------------------
+// Replaying (host)
+// ---------------------------------------------------------------------------
+#ifndef ESP_PLATFORM
+#include <map>
+#include <string>
+#include <vector>
+
+struct Rec {
+    uint8_t stream;
+    uint8_t kind;
+    int64_t value;
+};
+
+static const char* const KIND_NAMES[TRACE_KINDS] = {
+    "step", "clock", "random", "boot", "button", "scan", "flag",
+    "snapshot", "bus", "env", "frame", "lost", "end"
+};
+static const char* const STREAM_NAMES[TRACE_STREAMS] = { "logic", "render" };
+
+static std::vector<Rec>      recs;                       // file order
+static std::vector<uint32_t> byStream[TRACE_STREAMS];    // indices into recs
+static size_t                cursor[TRACE_STREAMS];
+static uint32_t              steps[TRACE_STREAMS];
+static bool                  cleanEnd;
+static std::string           error;
+static TimeUs                replayUs;
+
+static std::map<uint32_t, std::vector<uint8_t>> published;   // snapshots by sequence
+static uint32_t                                 newestSeq;
+
+static const Rec* at(int s, size_t i) {
+    return i < byStream[s].size() ? &recs[byStream[s][i]] : nullptr;
+}
+
+static void fail(int s, const char* what) {
+    if (!error.empty()) return;
+    char buf[160];
+    snprintf(buf, sizeof(buf), "%s step %u: %s", STREAM_NAMES[s], steps[s], what);
+    error = buf;
+}
+
+static bool next(int s, TraceKind kind) {
+    const Rec* r = at(s, cursor[s]);
+    return error.empty() && r && r->kind == kind;
+}
+
+static bool take(int s, TraceKind kind, int64_t& v) {
+    if (!error.empty()) return false;
+    const Rec* r = at(s, cursor[s]);
+    if (!r || r->kind != kind) {
+        char buf[96];
+        snprintf(buf, sizeof(buf), "read %s, the trace has %s", KIND_NAMES[kind],
+                 r ? KIND_NAMES[r->kind] : "nothing more");
+        fail(s, buf);
+        return false;
+    }
+    cursor[s]++;
+    v = r->value;
+    return true;
+}
+
+// A step is only offered once all of it was recorded: another step of its
+// stream follows, or recording was stopped cleanly
+static bool stepReady(int s) {
+    const Rec* r = at(s, cursor[s]);
+    if (!r || r->kind != TRACE_STEP) return false;
+    for (size_t i = cursor[s] + 1; (r = at(s, i)); i++) {
+        if (r->kind == TRACE_STEP) return true;
+        if (r->kind == TRACE_LOST || r->kind == TRACE_END) break;
+    }
+    return cleanEnd && !(r && r->kind == TRACE_LOST);
+}
+
+// Sequence of the snapshot the render step at the cursor drew, 0 if none
+static uint32_t snapshotWanted() {
+    const Rec* r;
+    for (size_t i = cursor[TRACE_RENDER] + 1; (r = at(TRACE_RENDER, i)) && r->kind != TRACE_STEP; i++)
+        if (r->kind == TRACE_SNAPSHOT) return (uint32_t)r->value;
+    return 0;
+}
+
+bool traceReplay(const uint8_t* data, size_t len) {
+    if (len < 5 || memcmp(data, TRACE_MAGIC, 4) != 0 || data[4] != TRACE_VERSION) return false;
+
+    recs.clear();
+    for (int s = 0; s < TRACE_STREAMS; s++) {
+        byStream[s].clear();
+        cursor[s] = 0;
+        steps[s]  = 0;
+        lastUs[s] = 0;
+    }
+    published.clear();
+    newestSeq = 0;
+    cleanEnd  = false;
+    error.clear();
+    replayUs  = 0;
+
+    // A capture cut off mid-record ends at the last whole one
+    for (size_t p = 5; p < len; ) {
+        Rec r;
+        r.stream = data[p] >> 4;
+        r.kind   = data[p] & 15;
+        if (r.stream >= TRACE_STREAMS || r.kind >= TRACE_KINDS) return false;
+        p++;
+
+        uint64_t u = 0;
+        if (hasValue((TraceKind)r.kind)) {
+            int shift = 0;
+            bool more = true;
+            while (more && p < len && shift < 64) {
+                u |= (uint64_t)(data[p] & 0x7F) << shift;
+                more = data[p++] & 0x80;
+                shift += 7;
+            }
+            if (more) break;
+        }
+        r.value = unzigzag(u);
+
+        if (r.kind == TRACE_END) cleanEnd = true;
+        byStream[r.stream].push_back((uint32_t)recs.size());
+        recs.push_back(r);
+    }
+
+    mode = MODE_REPLAY;
+    return true;
+}
+
+bool traceNextStep(TraceStream& s) {
+    if (mode != MODE_REPLAY || !error.empty()) return false;
+
+    int best = -1;
+    for (int t = 0; t < TRACE_STREAMS; t++)
+        if (stepReady(t) && (best < 0 || byStream[t][cursor[t]] < byStream[best][cursor[best]]))
+            best = t;
+
+    // On the device a frame can start before the logic step whose snapshot
+    // it ends up drawing
+    if (best == TRACE_RENDER && stepReady(TRACE_LOGIC) && (int32_t)(snapshotWanted() - newestSeq) > 0)
+        best = TRACE_LOGIC;
+
+    if (best < 0) return false;
+    s = (TraceStream)best;
+    return true;
+}
+
+TimeUs traceReplayUs() {
+    return replayUs;
+}
+
+const char* traceError() {
+    return error.empty() ? nullptr : error.c_str();
+}
+
+// Host recording goes straight to the driver's sink
+void traceRecord(TraceSink sink) {
+    startRecording(sink);
+}
+
+void traceStop() {
+    if (mode != MODE_RECORD) return;
+    put(TRACE_LOGIC, TRACE_END);
+    flush();
+    mode = MODE_OFF;
+}
+
+void traceBegin() {}
+
+static void replayEnter(int s) {
+    int64_t v;
+    take(s, TRACE_STEP, v);
+    steps[s]++;
+}
+
+static void replayLeave(int s) {
+    const Rec* r = at(s, cursor[s]);
+    if (r && r->kind != TRACE_STEP && r->kind != TRACE_END) fail(s, "left recorded inputs unread");
+}
+
+static void replayClock(TimeUs us) {
+    replayUs = max(replayUs, us);
+}
+
+static void replayPublished(uint32_t seq, const void* snap, size_t len) {
+    const uint8_t* p = (const uint8_t*)snap;
+    published[seq].assign(p, p + len);
+    newestSeq = seq;
+}
+
+static void replaySnapshot(int s, uint32_t seq, void* snap, size_t len) {
+    auto it = published.find(seq);
+    if (it == published.end() || it->second.size() != len) {
+        fail(s, "drew a snapshot the logic side never published");
+        return;
+    }
+    memcpy(snap, it->second.data(), len);
+}
+
+static void replayFrame(int s, uint32_t want, uint32_t crc) {
+    if (want != crc) fail(s, "drew a different frame");
+}
+#else
+// ---------------------------------------------------------------------------
+// Device: recorded to USB serial
+// ---------------------------------------------------------------------------
+static void serialSink(const uint8_t* data, size_t len) {
+    Serial.write(data, len);
+}
+
+void traceBegin() {
+    Serial.begin(115200);
+    while (!Serial) delay(10);
+    startRecording(serialSink);
+}
+
+// Nothing is replayed here
+static bool next(int, TraceKind)                                    { return false; }
+static bool take(int, TraceKind, int64_t&)                          { return false; }
+static void replayEnter(int)                                        {}
+static void replayLeave(int)                                        {}
+static void replayClock(TimeUs)                                     {}
+static void replayPublished(uint32_t, const void*, size_t)          {}
+static void replaySnapshot(int, uint32_t, void*, size_t)            {}
+static void replayFrame(int, uint32_t, uint32_t)                    {}
+#endif
+
+// ---------------------------------------------------------------------------
+// Steps
+// ---------------------------------------------------------------------------
+void traceEnter(TraceStream s) {
+    if (mode == MODE_OFF) return;
+    setStepping(s, true);
+
+    if (mode == MODE_RECORD) {
+        put(s, TRACE_STEP);
+        return;
+    }
+    replayEnter(s);
+}
+
+void traceLeave() {
+    int s = currentStream();
+    if (s < 0) return;
+    setStepping(s, false);
+
+    if (mode == MODE_RECORD) {
+        flush();
+        return;
+    }
+    replayLeave(s);
+}
+
+// ---------------------------------------------------------------------------
+// Taps
+// ---------------------------------------------------------------------------
+// monoUs() is also read from the button ISR, which must not leave IRAM
+TimeUs IRAM_ATTR traceClock(TimeUs live) {
+    if (mode == MODE_OFF) return live;
+#ifdef ESP_PLATFORM
+    if (xPortInIsrContext()) return live;
+#endif
+    int s = currentStream();
+    if (s < 0) return live;
+
+    if (mode == MODE_RECORD) {
+        put(s, TRACE_CLOCK, live - lastUs[s]);
+        return lastUs[s] = live;
+    }
+    int64_t d;
+    if (!take(s, TRACE_CLOCK, d)) return live;
+    lastUs[s] += d;
+    replayClock(lastUs[s]);
+    return lastUs[s];
+}
+
+int64_t traceValue(TraceKind kind, int64_t live) {
+    int s = currentStream();
+    if (s < 0) return live;
+
+    if (mode == MODE_RECORD) {
+        put(s, kind, live);
+        return live;
+    }
+    int64_t v;
+    return take(s, kind, v) ? v : live;
+}
+
+// The live source is still drained on a replay; what it had is not what
+// happened on the device
+bool tracePollButton(ButtonEvent& ev) {
+    int s = currentStream();
+    if (s < 0) return buttonsPoll(ev);
+
+    paused[s] = true;
+    bool got = buttonsPoll(ev);
+    paused[s] = false;
+
+    if (mode == MODE_RECORD) {
+        if (got) {
+            put(s, TRACE_BUTTON, ev.button * 2 + ev.pressed);
+            put(s, TRACE_BUTTON, ev.at - lastUs[s]);
+        }
+        return got;
+    }
+    int64_t id, stamp;
+    if (!next(s, TRACE_BUTTON) || !take(s, TRACE_BUTTON, id) || !take(s, TRACE_BUTTON, stamp)) return false;
+    ev.button  = (uint8_t)(id / 2);
+    ev.pressed = id & 1;
+    ev.at      = lastUs[s] + stamp;
+    return true;
+}
+
+bool tracePollBus(BusConsumer c, PetEvent& ev) {
+    int s = currentStream();
+    bool got = busPoll(c, ev);
+    if (s < 0) return got;
+
+    if (mode == MODE_RECORD) {
+        if (got) {
+            put(s, TRACE_BUS, ev.type + ev.arg * 256);
+            put(s, TRACE_BUS, ev.at - lastUs[s]);
+        }
+        return got;
+    }
+    int64_t id, stamp;
+    if (!next(s, TRACE_BUS) || !take(s, TRACE_BUS, id) || !take(s, TRACE_BUS, stamp)) return false;
+    ev.type = (PetEventType)(id & 0xFF);
+    ev.arg  = (uint8_t)(id >> 8);
+    ev.at   = lastUs[s] + stamp;
+    return true;
+}
+
+void tracePublished(uint32_t seq, const void* snap, size_t len) {
+    if (mode == MODE_REPLAY) replayPublished(seq, snap, len);
+}
+
+uint32_t traceSnapshot(uint32_t seq, uint32_t tries, void* snap, size_t len) {
+    int s = currentStream();
+    if (s < 0) return tries;
+
+    if (mode == MODE_RECORD) {
+        put(s, TRACE_SNAPSHOT, seq);
+        put(s, TRACE_SNAPSHOT, tries);
+        return tries;
+    }
+    int64_t want, n;
+    if (!take(s, TRACE_SNAPSHOT, want) || !take(s, TRACE_SNAPSHOT, n)) return tries;
+    replaySnapshot(s, (uint32_t)want, snap, len);
+    return (uint32_t)n;
+}
+
+void traceFrame(const void* pixels, size_t len) {
+    int s = currentStream();
+    if (s < 0) return;
+
+    uint32_t crc = crc32((const uint8_t*)pixels, len);
+    if (mode == MODE_RECORD) {
+        put(s, TRACE_FRAME, crc);
+        return;
+    }
+    int64_t want;
+    if (take(s, TRACE_FRAME, want)) replayFrame(s, (uint32_t)want, crc);
+}
+#endif
@@ -0,0 +1,122 @@
+#pragma once
+#include <Arduino.h>
+#include "monotonic.h"
+#include "buttons.h"
+#include "event_bus.h"
+
+// ============ Record / replay ============
+//
+// Everything the firmware does follows from its inputs, so a log of the
+// inputs is enough to run a session again. Each logic step and each
+// render step is bracketed by traceEnter()/traceLeave(); inside a step,
+// every value that does not follow from the firmware's own state passes
+// through a tap:
+//
+//   - every monoUs() read (TRACE_CLOCK)
+//   - the seed of the pet's random streams (TRACE_RANDOM)
+//   - what loadState() found in NVS (TRACE_BOOT)
+//   - every button event polled, with its ISR stamp (TRACE_BUTTON)
+//   - scan results (TRACE_SCAN) and flags another task set (TRACE_FLAG)
+//   - which snapshot a frame drew and the UI events it took (TRACE_SNAPSHOT,
+//     TRACE_BUS)
+//   - hardware figures put on screen: free heap, power counters (TRACE_ENV)
+//
+// Recording appends each tap to a compact stream: one tag byte (stream,
+// kind) and a zigzag varint, clock reads as the change since the last one
+// on the same stream. After each frame the CRC-32 of the frame buffer is
+// appended too. On the device the stream goes out over USB serial; when
+// the host does not keep up and the buffer fills, recording stops and a
+// TRACE_LOST record says so.
+//
+// Replaying runs the same steps in the same order on the host, and each
+// tap hands back the recorded value instead of the live one: the steps
+// take the same branches, draw the same frames and finish with the same
+// CRCs, as fast as the host can go. The two streams only meet through the
+// snapshot (kept by sequence, so a frame gets the one it drew on the
+// device), the UI events and the flags, all recorded, so the order the
+// two cores interleaved in does not matter. A replay that reads a
+// different kind of input than was recorded, or draws a different frame,
+// stops and says where (traceError()). The replay has to be built from
+// the same source with the same options as the recording.
+//
+// TAMAFI_TRACE=1 builds the taps in; otherwise they are the live value.
+// A device build with it waits for the host to open the USB port at boot
+// and never light-sleeps, which would drop the port:
+//
+//   cat /dev/ttyACM0 > session.trace
+//   sim/tamafi_replay session.trace
+
+#ifndef TAMAFI_TRACE
+#define TAMAFI_TRACE 0
+#endif
+
+#define TRACE_MAGIC         "TFTR"
+#define TRACE_VERSION       1
+#define TRACE_BUFFER_SIZE   16384     // device: bytes held until USB takes them (power of two)
+
+enum TraceStream : uint8_t {
+  TRACE_LOGIC,        // setup() and logic steps
+  TRACE_RENDER,
+  TRACE_STREAMS
+};
+
+enum TraceKind : uint8_t {
+  TRACE_STEP,         // a step starts; no value
+  TRACE_CLOCK,
+  TRACE_RANDOM,
+  TRACE_BOOT,
+  TRACE_BUTTON,       // button * 2 + pressed, then the stamp against the last clock read
+  TRACE_SCAN,
+  TRACE_FLAG,
+  TRACE_SNAPSHOT,     // sequence, then read attempts
+  TRACE_BUS,          // type + arg * 256, then the stamp against the last clock read
+  TRACE_ENV,
+  TRACE_FRAME,        // checked on replay, not fed back
+  TRACE_LOST,         // the buffer overflowed and recording stopped; no value
+  TRACE_END,          // recording was stopped; no value
+  TRACE_KINDS
+};
+
+#if TAMAFI_TRACE
+void     traceBegin();                            // setup(): the device starts recording
+void     traceEnter(TraceStream s);
+void     traceLeave();
+
+TimeUs   traceClock(TimeUs live);                 // monoUs()
+int64_t  traceValue(TraceKind kind, int64_t live);
+bool     tracePollButton(ButtonEvent& ev);        // buttonsPoll()
+bool     tracePollBus(BusConsumer c, PetEvent& ev);
+
+// Logic side, after each write; render side, after each read. Returns the
+// read attempts.
+void     tracePublished(uint32_t seq, const void* snap, size_t len);
+uint32_t traceSnapshot(uint32_t seq, uint32_t tries, void* snap, size_t len);
+
+void     traceFrame(const void* pixels, size_t len);
+#else
+inline void     traceBegin()                                    {}
+inline void     traceEnter(TraceStream)                         {}
+inline void     traceLeave()                                    {}
+inline TimeUs   traceClock(TimeUs live)                         { return live; }
+inline int64_t  traceValue(TraceKind, int64_t live)             { return live; }
+inline bool     tracePollButton(ButtonEvent& ev)                { return buttonsPoll(ev); }
+inline bool     tracePollBus(BusConsumer c, PetEvent& ev)       { return busPoll(c, ev); }
+inline void     tracePublished(uint32_t, const void*, size_t)   {}
+inline uint32_t traceSnapshot(uint32_t, uint32_t tries, void*, size_t) { return tries; }
+inline void     traceFrame(const void*, size_t)                 {}
+#endif
+
+#if TAMAFI_TRACE && !defined(ESP_PLATFORM)
+// Host: the driver records to a sink or replays a trace it loaded, before
+// setup()
+typedef void (*TraceSink)(const uint8_t* data, size_t len);
+
+void        traceRecord(TraceSink sink);
+void        traceStop();                          // flush and stop recording
+bool        traceReplay(const uint8_t* data, size_t len);
+
+// Which step ran next on the device; false at the end of the trace
+bool        traceNextStep(TraceStream& s);
+TimeUs      traceReplayUs();                      // latest clock read handed back
+const char* traceError();                         // nullptr while the replay holds
+#endif
@@ -1,769 +1,984 @@
-#include <Arduino.h>
-#include "ui.h"
-#include "ui_anim.h"
-
-// Graphics headers
-#include "StoneGolem.h"
-#include "egg_hatch.h"
-#include "effect.h"
-#include "background.h"
-
-static const int TFT_W = 240;
-static const int TFT_H = 240;
-static const int PET_W = 115;
-static const int PET_H = 110;
-static const int EFFECT_W = 100;
-static const int EFFECT_H = 95;
-
-// Hunting animation
-static int huntFrame = 0;
-static unsigned long lastHuntFrameTime = 0;
-static const int HUNT_FRAME_DELAY = 300;   // adjust speed
-
-// Idle sprite sets per stage (placeholder: same for all)
-static const uint16_t* BABY_IDLE_FRAMES[4]  = { idle_1, idle_2, idle_3, idle_4 };
-static const uint16_t* TEEN_IDLE_FRAMES[4]  = { idle_1, idle_2, idle_3, idle_4 };
-static const uint16_t* ADULT_IDLE_FRAMES[4] = { idle_1, idle_2, idle_3, idle_4 };
-static const uint16_t* ELDER_IDLE_FRAMES[4] = { idle_1, idle_2, idle_3, idle_4 };
-
-// Egg frames
-static const uint16_t* EGG_FRAMES[5] = {
-    egg_hatch_1, egg_hatch_2, egg_hatch_3, egg_hatch_4, egg_hatch_5
-};
-
-static const uint16_t* EGG_IDLE_FRAMES[4] = {
-    egg_hatch_11, egg_hatch_21, egg_hatch_31, egg_hatch_41
-};
-
-static const uint16_t* HUNGER_FRAMES[4] = {
-    hunger1, hunger2, hunger3, hunger4
-};
-
-static const uint16_t* DEAD_FRAMES[3] = {
-    dead_1, dead_2, dead_3
-};
-
-// HUNTING animation loop
-static const uint16_t* ATTACK_FRAMES[3] = {
-    attack_0, attack_1, attack_2
-};
-
-
-// Local UI state
-static int idleFrameUi = 0;
-static unsigned long lastIdleFrameUi = 0;
-
-static int eggIdleFrameUi = 0;
-static unsigned long lastEggIdleTimeUi = 0;
-
-static int hatchFrameUi = 0;
-static unsigned long lastHatchFrameUi = 0;
-
-static int deadFrameUi = 0;
-static unsigned long lastDeadFrameUi = 0;
-
-// Highlight animation states
-static int menuHighlightY        = 30;
-static int menuHighlightTargetY  = 30;
-static unsigned long lastMenuAnimTime = 0;
-
-static int ctlHighlightY         = 30;
-static int ctlHighlightTargetY   = 30;
-static unsigned long lastCtlAnim = 0;
-
-static int setHighlightY         = 30;
-static int setHighlightTargetY   = 30;
-static unsigned long lastSetAnim = 0;
-
-static const int MAIN_MENU_COUNT = 7;
-
-// ---------------------------------------------------------------------------
-// UNIVERSAL HIGHLIGHT ALIGNMENT
-// ---------------------------------------------------------------------------
-static int calcHighlightY(int rowIndex, int rowHeight, int topOffset) {
-    return topOffset + rowIndex * rowHeight - 5;  // centered under text
-}
-
-static const char* moodTextLocal(Mood m) {
-    switch (m) {
-        case MOOD_HUNGRY:  return "HUNGRY";
-        case MOOD_HAPPY:   return "HAPPY";
-        case MOOD_CURIOUS: return "CURIOUS";
-        case MOOD_BORED:   return "BORED";
-        case MOOD_SICK:    return "SICK";
-        case MOOD_EXCITED: return "EXCITED";
-        case MOOD_CALM:    return "CALM";
-    }
-    return "?";
-}
-
-static const char* stageTextLocal(Stage s) {
-    switch (s) {
-        case STAGE_BABY:  return "BABY";
-        case STAGE_TEEN:  return "TEEN";
-        case STAGE_ADULT: return "ADULT";
-        case STAGE_ELDER: return "ELDER";
-    }
-    return "?";
-}
-
-static const char* activityTextLocal(Activity a) {
-    switch (a) {
-        case ACT_HUNT:     return "HUNTING WIFI...";
-        case ACT_DISCOVER: return "DISCOVERING...";
-        case ACT_REST:     return "RESTING...";
-        default:           return "";
-    }
-}
-
-static void drawHeader(const char* title) {
-    fb.fillRect(0, 0, TFT_W, 18, TFT_BLACK);
-    fb.drawLine(0, 18, TFT_W, 18, TFT_CYAN);
-    fb.drawLine(0, 19, TFT_W, 19, TFT_MAGENTA);
-
-    fb.fillRect(5, 6, 6, 6, TFT_WHITE);
-    fb.fillRect(6, 7, 4, 4, TFT_BLACK);
-
-    fb.setTextColor(TFT_WHITE);
-    fb.setCursor(18, 5);
-    fb.print(title);
-}
-
-static void drawBar(int x, int y, int w, int h, int value, uint16_t color) {
-    fb.drawRect(x, y, w, h, TFT_WHITE);
-    int fillWidth = (w - 2) * value / 100;
-    fb.fillRect(x + 1, y + 1, fillWidth, h - 2, color);
-}
-
-static void drawBubble(int x, int y, bool selected) {
-    if (selected) {
-        fb.fillCircle(x, y, 4, TFT_WHITE);
-        fb.fillCircle(x, y, 2, TFT_BLACK);
-    } else {
-        fb.drawCircle(x, y, 4, TFT_WHITE);
-    }
-}
-
-static void drawMenuIcon(int iconIndex, int x, int y) {
-    switch (iconIndex) {
-        case 0: fb.drawRect(x, y+3, 5, 4, TFT_WHITE); fb.fillRect(x+1,y+4,3,2,TFT_WHITE); break;
-        case 1: fb.drawLine(x+2,y+8,x+5,y+2,TFT_WHITE); fb.drawLine(x+8,y+8,x+5,y+2,TFT_WHITE); fb.fillRect(x+4,y+8,2,3,TFT_WHITE); break;
-        case 2: fb.drawRect(x+1,y+2,8,6,TFT_WHITE); fb.drawPixel(x,y+3,TFT_WHITE); fb.drawPixel(x+9,y+3,TFT_WHITE); break;
-        case 3: fb.drawLine(x+1,y+3,x+9,y+3,TFT_WHITE); fb.fillRect(x+3,y+2,3,3,TFT_WHITE); break;
-        case 4: fb.drawCircle(x+5,y+5,3,TFT_WHITE); break;
-        case 5: fb.fillRect(x+4,y+2,2,2,TFT_WHITE); break;
-        case 6: fb.drawLine(x+8,y+4,x+2,y+4,TFT_WHITE); fb.drawLine(x+2,y+4,x+4,y+2,TFT_WHITE); break;
-    }
-}
-
-static void animateSelector(int &pos, int &target, unsigned long &lastTick) {
-    unsigned long now = millis();
-    if (now - lastTick < MENU_ANIM_INTERVAL) return;
-    lastTick = now;
-    if (pos == target) return;
-
-    int diff = target - pos;
-    int step = (diff > 0) ? MENU_ANIM_STEP : -MENU_ANIM_STEP;
-    if (abs(diff) < MENU_ANIM_STEP) pos = target;
-    else pos += step;
-}
-
-static const uint16_t** currentIdleSet() {
-    switch (petStage) {
-        case STAGE_BABY:  return BABY_IDLE_FRAMES;
-        case STAGE_TEEN:  return TEEN_IDLE_FRAMES;
-        case STAGE_ADULT: return ADULT_IDLE_FRAMES;
-        case STAGE_ELDER: return ELDER_IDLE_FRAMES;
-    }
-    return BABY_IDLE_FRAMES;
-}
-
-// ---------------------------------------------------------------------------
-// BOOT SCREEN
-// ---------------------------------------------------------------------------
-static void screenBoot() {
-    fb.fillSprite(TFT_BLACK);
-    drawHeader("TamaFi v2");
-
-    fb.setTextColor(TFT_WHITE);
-    fb.setCursor(20, 60);
-    fb.print("WiFi-fed Virtual Pet");
-
-    fb.setCursor(20, 100);
-    fb.print("Press any button...");
-
-    fb.pushSprite(0, 0);
-}
-
-// ---------------------------------------------------------------------------
-// HATCH SCREEN (Idle egg → OK → hatch → home)
-// ---------------------------------------------------------------------------
-static void screenHatch() {
-    ledcWriteTone(5, 0);
-    fb.fillSprite(TFT_BLACK);
-    drawHeader("Hatching...");
-
-    fb.pushImage(0, 18, TFT_W, TFT_H - 18, backgroundImage2);
-    unsigned long now = millis();
-
-    // 1) Idle egg animation until OK pressed
-    if (!hasHatchedOnce && !hatchTriggered) {
-        if (now - lastEggIdleTimeUi >= EGG_IDLE_DELAY) {
-            lastEggIdleTimeUi = now;
-            eggIdleFrameUi = (eggIdleFrameUi + 1) % 4;
-        }
-
-        petSprite.pushImage(0, 0, PET_W, PET_H, EGG_IDLE_FRAMES[eggIdleFrameUi]);
-        petSprite.pushToSprite(&fb, 70, 80, TFT_WHITE);
-
-        //fb.setCursor(10, 200);
-        //fb.setTextColor(TFT_WHITE);
-        //fb.print("Press OK to hatch");
-
-        fb.pushSprite(0, 0);
-        return;
-    }
-
-    // 2) Triggered hatch animation
-    if (!hasHatchedOnce && hatchTriggered) {
-      if (hatchFrameUi == 0) {
-        sndHatch();    // <<< PLAY RETRO HATCH SOUND HERE
-        }
-        if (now - lastHatchFrameUi >= HATCH_DELAY) {
-            lastHatchFrameUi = now;
-
-            if (hatchFrameUi < 4) hatchFrameUi++;
-            else {
-                hasHatchedOnce = true;
-                hatchTriggered = false;
-                hatchFrameUi   = 0;
-                currentScreen  = SCREEN_HOME;
-                uiOnScreenChange(currentScreen);
-                return;
-            }
-        }
-
-        petSprite.pushImage(0, 0, PET_W, PET_H, EGG_FRAMES[hatchFrameUi]);
-        petSprite.pushToSprite(&fb, 70, 80, TFT_WHITE);
-
-        //fb.setCursor(10, 200);
-        //fb.setTextColor(TFT_WHITE);
-        //fb.print("Hatching...");
-
-        fb.pushSprite(0, 0);
-        return;
-    }
-
-    // Safety fallback
-    currentScreen = SCREEN_HOME;
-    uiOnScreenChange(currentScreen);
-}
-
-// ---------------------------------------------------------------------------
-// HOME SCREEN
-// ---------------------------------------------------------------------------
-
-static void drawStatsBlock() {
-    int x = 20, y = 100, w = 80, h = 8;
-
-    drawBar(x, y,       w, h, pet.hunger,    TFT_RED);
-    drawBar(x, y + 28,  w, h, pet.happiness, TFT_YELLOW);
-    drawBar(x, y + 56,  w, h, pet.health,    TFT_GREEN);
-
-    fb.setTextColor(TFT_BLACK);
-    fb.setCursor(x + 3, y + 75);
-    fb.print("Mood:  ");
-    fb.print(moodTextLocal(currentMood));
-
-    fb.setCursor(x + 3, y + 89);
-    fb.print("Stage: ");
-    fb.print(stageTextLocal(petStage));
-}
-
-static void screenHome() {
-    fb.fillSprite(TFT_BLACK);
-
-    // ===== TOP BAR MESSAGE =====
-    if (currentActivity != ACT_NONE)
-        drawHeader(activityTextLocal(currentActivity));
-    else
-        drawHeader("Idle");
-
-    fb.pushImage(0, 18, TFT_W, TFT_H - 18, backgroundImage);
-
-    unsigned long now = millis();
-
-    // =============================
-    //        REST ANIMATION
-    // =============================
-    if (currentActivity == ACT_REST && restPhase != REST_NONE) {
-
-        int frameIdx = 0;
-
-        if (restPhase == REST_ENTER) {
-            // Going to sleep → 5 → 4 → 3 → 2 → 1
-            frameIdx = 4 - constrain(restFrameIndex, 0, 4);
-        }
-        else if (restPhase == REST_DEEP) {
-            // Deep sleeping → always frame 1 (egg_hatch_1)
-            frameIdx = 0;
-        }
-        else if (restPhase == REST_WAKE) {
-            // Waking up → 1 → 2 → 3 → 4 → 5
-            frameIdx = constrain(restFrameIndex, 0, 4);
-        }
-
-        petSprite.pushImage(0, 0, PET_W, PET_H, EGG_FRAMES[frameIdx]);
-        petSprite.pushToSprite(&fb, petPosX, petPosY, TFT_WHITE);
-
-        // --- Always draw stats ---
-        drawStatsBlock();
-
-        fb.pushSprite(0, 0);
-        return;
-    }
-
-    // =============================
-    //        HUNTING ANIMATION
-    // =============================
-    if (currentActivity == ACT_HUNT) {
-
-        if (now - lastHuntFrameTime >= HUNT_FRAME_DELAY) {
-            lastHuntFrameTime = now;
-            huntFrame = (huntFrame + 1) % 3;   // attack_0 → attack_1 → attack_2
-        }
-
-        petSprite.pushImage(0, 0, PET_W, PET_H, ATTACK_FRAMES[huntFrame]);
-        petSprite.pushToSprite(&fb, petPosX, petPosY, TFT_WHITE);
-
-        drawStatsBlock();
-
-        fb.pushSprite(0, 0);
-        return;
-    }
-
-    // =============================
-    //        IDLE ANIMATION
-    // =============================
-    int idleSpeed = IDLE_BASE_DELAY;
-    if (currentMood == MOOD_EXCITED) idleSpeed = IDLE_FAST_DELAY;
-    if (currentMood == MOOD_BORED || currentMood == MOOD_SICK) idleSpeed = IDLE_SLOW_DELAY;
-
-    if (now - lastIdleFrameUi >= (unsigned long)idleSpeed) {
-        lastIdleFrameUi = now;
-        idleFrameUi = (idleFrameUi + 1) % 4;
-    }
-
-    const uint16_t** idleSet = currentIdleSet();
-    petSprite.pushImage(0, 0, PET_W, PET_H, idleSet[idleFrameUi]);
-    petSprite.pushToSprite(&fb, petPosX, petPosY, TFT_WHITE);
-
-    // =============================
-    //         ALWAYS DRAW STATS
-    // =============================
-    drawStatsBlock();
-
-    // =============================
-    //     HUNGER EFFECT OVERLAY
-    // =============================
-    if (hungerEffectActive) {
-        effectSprite.pushImage(0, 0, EFFECT_W, EFFECT_H, HUNGER_FRAMES[hungerEffectFrame]);
-        effectSprite.pushToSprite(&fb, 120, 90, TFT_WHITE);
-    }
-
-    fb.pushSprite(0, 0);
-}
-
-
-// ---------------------------------------------------------------------------
-// MAIN MENU
-// ---------------------------------------------------------------------------
-static void screenMenu(int mainMenuIndex) {
-    fb.fillSprite(TFT_BLACK);
-    drawHeader("Main Menu");
-
-    animateSelector(menuHighlightY, menuHighlightTargetY, lastMenuAnimTime);
-
-    fb.fillRect(8, menuHighlightY, 224, 18, TFT_DARKGREY);
-    fb.drawRect(8, menuHighlightY, 224, 18, TFT_CYAN);
-
-    const char* items[] = {
-        "Pet Status",
-        "Environment",
-        "System Info",
-        "Controls",
-        "Settings",
-        "Diagnostics",
-        "Back"
-    };
-
-    int baseY = 30;
-    int step  = 20;
-
-    for (int i = 0; i < MAIN_MENU_COUNT; i++) {
-        int y = baseY + i * step;
-
-        drawMenuIcon(i, 16, y - 2);
-
-        fb.setCursor(40, y);
-        fb.setTextColor(i == mainMenuIndex ? TFT_YELLOW : TFT_WHITE);
-        fb.print(items[i]);
-    }
-
-    fb.setCursor(10, 200);
-    fb.setTextColor(TFT_WHITE);
-    fb.print("UP/DOWN = move | OK = select");
-
-    fb.pushSprite(0, 0);
-}
-
-// ---------------------------------------------------------------------------
-// PET STATUS
-// ---------------------------------------------------------------------------
-static void screenPetStatus() {
-    fb.fillSprite(TFT_BLACK);
-    drawHeader("Pet Status");
-
-    fb.setTextColor(TFT_WHITE);
-
-    fb.setCursor(10, 26);
-    fb.print("Stage: ");  fb.print(stageTextLocal(petStage));
-
-    fb.setCursor(10,38);
-    fb.print("Age:   ");
-    fb.print(pet.ageDays); fb.print("d ");
-    fb.print(pet.ageHours); fb.print("h ");
-    fb.print(pet.ageMinutes); fb.print("m");
-
-
-    fb.setCursor(10, 56);
-    fb.print("Hunger: "); fb.print(pet.hunger); fb.print("%");
-
-    fb.setCursor(10, 68);
-    fb.print("Happy:  "); fb.print(pet.happiness); fb.print("%");
-
-    fb.setCursor(10, 80);
-    fb.print("Health: "); fb.print(pet.health); fb.print("%");
-
-    fb.setCursor(10, 98);
-    fb.print("Mood:   "); fb.print(moodTextLocal(currentMood));
-
-    fb.setCursor(10, 116);
-    fb.print("Personality:");
-
-    fb.setCursor(16, 130);
-    fb.print("Curiosity: "); fb.print((int)traitCuriosity);
-
-    fb.setCursor(16, 142);
-    fb.print("Activity : "); fb.print((int)traitActivity);
-
-    fb.setCursor(16, 154);
-    fb.print("Stress   : "); fb.print((int)traitStress);
-
-    fb.setCursor(10, 200);
-    fb.print("OK = Back");
-
-    fb.pushSprite(0, 0);
-}
-
-// ---------------------------------------------------------------------------
-// ENVIRONMENT
-// ---------------------------------------------------------------------------
-static void screenEnvironment() {
-    fb.fillSprite(TFT_BLACK);
-    drawHeader("Environment");
-
-    fb.setTextColor(TFT_WHITE);
-
-    fb.setCursor(10, 30);
-    fb.print("Networks : "); fb.print(wifiStats.netCount);
-
-    fb.setCursor(10, 42);
-    fb.print("Strong   : "); fb.print(wifiStats.strongCount);
-
-    fb.setCursor(10, 54);
-    fb.print("Hidden   : "); fb.print(wifiStats.hiddenCount);
-
-    fb.setCursor(10, 66);
-    fb.print("Open     : "); fb.print(wifiStats.openCount);
-
-    fb.setCursor(10, 78);
-    fb.print("WPA/etc  : "); fb.print(wifiStats.wpaCount);
-
-    fb.setCursor(10, 94);
-    fb.print("Avg RSSI : "); fb.print(wifiStats.avgRSSI);
-
-    fb.setCursor(10, 200);
-    fb.print("OK = Back");
-
-    fb.pushSprite(0, 0);
-}
-
-// ---------------------------------------------------------------------------
-// SYSTEM INFO
-// ---------------------------------------------------------------------------
-static void screenSysInfo() {
-    fb.fillSprite(TFT_BLACK);
-    drawHeader("System Info");
-
-    fb.setTextColor(TFT_WHITE);
-
-    fb.setCursor(10, 30);
-    fb.print("Firmware: 2.0");
-
-    fb.setCursor(10, 42);
-    fb.print("MCU:      ESP32");
-
-    fb.setCursor(10, 54);
-    fb.print("Heap Free: ");
-    fb.print(ESP.getFreeHeap() / 1024); fb.print(" KB");
-
-    unsigned long s = millis() / 1000;
-    unsigned long m = s / 60;
-    unsigned long h = m / 60;
-    s %= 60; m %= 60;
-
-    fb.setCursor(10, 72);
-    fb.print("Uptime: ");
-    fb.printf("%02lu:%02lu:%02lu", h, m, s);
-
-    fb.setCursor(10, 90);
-    fb.print("WiFi Scan: ");
-    fb.print(wifiScanInProgress ? "Running" : "Idle");
-
-    fb.setCursor(10, 200);
-    fb.print("OK = Back");
-
-    fb.pushSprite(0, 0);
-}
-
-// ---------------------------------------------------------------------------
-// CONTROLS MENU
-// ---------------------------------------------------------------------------
-static void screenControls(int controlsIndex) {
-    fb.fillSprite(TFT_BLACK);
-    drawHeader("Controls");
-
-    animateSelector(ctlHighlightY, ctlHighlightTargetY, lastCtlAnim);
-
-    fb.fillRect(8, ctlHighlightY, 224, 18, TFT_DARKGREY);
-    fb.drawRect(8, ctlHighlightY, 224, 18, TFT_CYAN);
-
-    const char* labels[] = {
-        "Screen Brightness",
-        "LED Brightness",
-        "Sound",
-        "NeoPixels",
-        "Back"
-    };
-
-    fb.setTextColor(TFT_WHITE);
-    fb.setTextSize(1);
-
-    int baseY = 30;
-    int step  = 20;
-
-    for (int i = 0; i < 5; i++) {
-        int y = baseY + i * step;
-
-        drawBubble(14, y, i == controlsIndex);
-
-        fb.setCursor(30, y - 4);
-        fb.setTextColor(i == controlsIndex ? TFT_YELLOW : TFT_WHITE);
-        fb.print(labels[i]);
-
-        fb.setCursor(150, y - 4);
-        fb.setTextColor(TFT_CYAN);
-
-        switch (i) {
-            case 0:
-                fb.print(tftBrightnessIndex==0?"Low":tftBrightnessIndex==1?"Mid":"High");
-                break;
-            case 1:
-                fb.print(ledBrightnessIndex==0?"Low":ledBrightnessIndex==1?"Mid":"High");
-                break;
-            case 2:
-                fb.print(soundEnabled?"On":"Off");
-                break;
-            case 3:
-                fb.print(neoPixelsEnabled?"On":"Off");
-                break;
-        }
-    }
-
-    fb.setCursor(10, 200);
-    fb.print("OK = Select/Back");
-
-    fb.pushSprite(0, 0);
-}
-
-// ---------------------------------------------------------------------------
-// SETTINGS MENU
-// ---------------------------------------------------------------------------
-static void screenSettings(int settingsMenuIndex) {
-    fb.fillSprite(TFT_BLACK);
-    drawHeader("Settings");
-
-    animateSelector(setHighlightY, setHighlightTargetY, lastSetAnim);
-
-    fb.fillRect(8, setHighlightY, 224, 18, TFT_DARKGREY);
-    fb.drawRect(8, setHighlightY, 224, 18, TFT_CYAN);
-
-    const char* labels[] = {
-        "Theme",
-        "Auto Sleep",
-        "Auto Save",
-        "Reset Pet",
-        "Reset All",
-        "Back"
-    };
-
-    int baseY = 30;
-    int step  = 18;
-
-    for (int i = 0; i < 6; i++) {
-        int y = baseY + i * step;
-
-        drawBubble(14, y, i == settingsMenuIndex);
-
-        fb.setCursor(30, y - 4);
-        fb.setTextColor(i == settingsMenuIndex ? TFT_YELLOW : TFT_WHITE);
-        fb.print(labels[i]);
-
-        fb.setCursor(150, y - 4);
-        fb.setTextColor(TFT_CYAN);
-
-        switch (i) {
-            case 0: fb.print("Pixel"); break;
-            case 1: fb.print(autoSleep?"On":"Off"); break;
-            case 2: fb.print(autoSaveMs/1000); fb.print("s"); break;
-        }
-    }
-
-    fb.setCursor(10, 200);
-    fb.print("OK = Select");
-
-    fb.pushSprite(0, 0);
-}
-
-// ---------------------------------------------------------------------------
-// DIAGNOSTICS
-// ---------------------------------------------------------------------------
-static void screenDiagnostics() {
-    fb.fillSprite(TFT_BLACK);
-    drawHeader("Diagnostics");
-
-    fb.setTextColor(TFT_WHITE);
-
-    fb.setCursor(10, 30);
-    fb.print("Activity: ");
-    fb.print(activityTextLocal(currentActivity));
-
-    fb.setCursor(10, 42);
-    fb.print("Mood: ");
-    fb.print(moodTextLocal(currentMood));
-
-    fb.setCursor(10, 54);
-    fb.print("RestPhase: ");
-    fb.print(restPhase==REST_ENTER?"ENTER":
-             restPhase==REST_DEEP ?"DEEP":
-             restPhase==REST_WAKE ?"WAKE":"NONE");
-
-    fb.setCursor(10, 66);
-    fb.print("WiFi Scan: ");
-    fb.print(wifiScanInProgress?"Running":"Idle");
-
-    fb.setCursor(10, 200);
-    fb.print("OK = Back");
-
-    fb.pushSprite(0, 0);
-}
-
-// ---------------------------------------------------------------------------
-// GAME OVER
-// ---------------------------------------------------------------------------
-static void screenGameOver() {
-    fb.fillSprite(TFT_BLACK);
-    drawHeader("Game Over");
-
-    unsigned long now = millis();
-    if (now - lastDeadFrameUi >= DEAD_DELAY) {
-        lastDeadFrameUi = now;
-        //deadFrameUi = (deadFrameUi + 1) % DEAD_FRAME_COUNT;
-        deadFrameUi++;
-        if (deadFrameUi > 2) deadFrameUi = 2;
-    }
-
-    fb.pushImage(0, 18, TFT_W, TFT_H - 18, backgroundImage);
-
-    petSprite.pushImage(0, 0, PET_W, PET_H, DEAD_FRAMES[deadFrameUi]);
-    petSprite.pushToSprite(&fb, petPosX, petPosY, TFT_WHITE);
-
-    //fb.setCursor(10, 200);
-    //fb.setTextColor(TFT_WHITE);
-    //fb.print("OK = Restart");
-
-    fb.pushSprite(0, 0);
-}
-
-// ---------------------------------------------------------------------------
-// PUBLIC UI API
-// ---------------------------------------------------------------------------
-void uiInit() {
-    idleFrameUi = 0;
-    lastIdleFrameUi = millis();
-
-    eggIdleFrameUi = 0;
-    lastEggIdleTimeUi = millis();
-
-    hatchFrameUi = 0;
-    lastHatchFrameUi = millis();
-
-    deadFrameUi = 0;
-    lastDeadFrameUi = millis();
-}
-
-void uiOnScreenChange(Screen newScreen) {
-    if (newScreen == SCREEN_MENU) {
-        menuHighlightY = menuHighlightTargetY = calcHighlightY(mainMenuIndex, 20, 30);
-    }
-    if (newScreen == SCREEN_CONTROLS) {
-        ctlHighlightY  = ctlHighlightTargetY = calcHighlightY(controlsIndex, 20, 30);
-    }
-    if (newScreen == SCREEN_SETTINGS) {
-        setHighlightY  = setHighlightTargetY = calcHighlightY(settingsMenuIndex, 18, 30);
-    }
-    if (newScreen == SCREEN_HATCH) {
-        eggIdleFrameUi = hatchFrameUi = 0;
-    }
-}
-
-void uiDrawScreen(Screen screen,
-                  int mainMenuIdx,
-                  int controlsIdx,
-                  int settingsIdx)
-{
-    if (screen == SCREEN_MENU) {
-        menuHighlightTargetY = calcHighlightY(mainMenuIdx, 20, 30);
-    }
-    if (screen == SCREEN_CONTROLS) {
-        ctlHighlightTargetY = calcHighlightY(controlsIdx, 20, 30) - 4;
-    }
-    if (screen == SCREEN_SETTINGS) {
-        setHighlightTargetY = calcHighlightY(settingsMenuIndex, 18, 30) - 4;
-    }
-
-    switch (screen) {
-        case SCREEN_BOOT:        screenBoot(); break;
-        case SCREEN_HATCH:       screenHatch(); break;
-        case SCREEN_HOME:        screenHome(); break;
-        case SCREEN_MENU:        screenMenu(mainMenuIdx); break;
-        case SCREEN_PET_STATUS:  screenPetStatus(); break;
-        case SCREEN_ENVIRONMENT: screenEnvironment(); break;
-        case SCREEN_SYSINFO:     screenSysInfo(); break;
-        case SCREEN_CONTROLS:    screenControls(controlsIdx); break;
-        case SCREEN_SETTINGS:    screenSettings(settingsIdx); break;
-        case SCREEN_DIAGNOSTICS: screenDiagnostics(); break;
-        case SCREEN_GAMEOVER:    screenGameOver(); break;
-    }
-}
+#include <Arduino.h>
+#include "ui.h"
+#include "ui_anim.h"
+#include "rgb565.h"
+#include "stamp_cache.h"
+#include "menu.h"
+#include "power.h"
+#include "event_bus.h"
+#include "trace.h"
+
+// Graphics headers
+#include "StoneGolem.h"
+#include "egg_hatch.h"
+#include "effect.h"
+#include "background.h"
+
+static const int TFT_W = 240;
+static const int TFT_H = 240;
+static const int PET_W = 115;
+static const int PET_H = 110;
+static const int EFFECT_W = 100;
+static const int EFFECT_H = 95;
+
+// Hunting animation
+static int huntFrame = 0;
+static TimeMs lastHuntFrameTime = 0;
+static const int HUNT_FRAME_DELAY = 300;   // adjust speed
+
+// Idle sprite sets per stage (placeholder: same for all)
+static const uint16_t* BABY_IDLE_FRAMES[4]  = { idle_1, idle_2, idle_3, idle_4 };
+static const uint16_t* TEEN_IDLE_FRAMES[4]  = { idle_1, idle_2, idle_3, idle_4 };
+static const uint16_t* ADULT_IDLE_FRAMES[4] = { idle_1, idle_2, idle_3, idle_4 };
+static const uint16_t* ELDER_IDLE_FRAMES[4] = { idle_1, idle_2, idle_3, idle_4 };
+
+// Egg frames
+static const uint16_t* EGG_FRAMES[5] = {
+    egg_hatch_1, egg_hatch_2, egg_hatch_3, egg_hatch_4, egg_hatch_5
+};
+
+static const uint16_t* EGG_IDLE_FRAMES[4] = {
+    egg_hatch_11, egg_hatch_21, egg_hatch_31, egg_hatch_41
+};
+
+static const uint16_t* HUNGER_FRAMES[4] = {
+    hunger1, hunger2, hunger3, hunger4
+};
+
+static const uint16_t* DEAD_FRAMES[3] = {
+    dead_1, dead_2, dead_3
+};
+
+// HUNTING animation loop
+static const uint16_t* ATTACK_FRAMES[3] = {
+    attack_0, attack_1, attack_2
+};
+
+
+// Local UI state
+static int idleFrameUi = 0;
+static TimeMs lastIdleFrameUi = 0;
+
+static int eggIdleFrameUi = 0;
+static TimeMs lastEggIdleTimeUi = 0;
+
+static int hatchFrameUi = 0;
+static TimeMs lastHatchFrameUi = 0;
+
+static int deadFrameUi = 0;
+static TimeMs lastDeadFrameUi = 0;
+
+// Highlight animation state (one menu is on screen at a time)
+static int menuHighlightY        = MENU_TOP_Y;
+static int menuHighlightTargetY  = MENU_TOP_Y;
+static TimeMs lastMenuAnimTime = 0;
+
+// State this frame is drawn from (copied out of the logic side's seqlock)
+static UiSnapshot snap;
+static uint32_t   snapRetries = 0;        // reads that raced a publish
+
+// Region of fb a screen changed this frame (uiDrawScreen pushes it)
+static int presentX = 0, presentY = 0, presentW = TFT_W, presentH = TFT_H;
+
+static void setPresentRect(int x, int y, int w, int h) {
+    presentX = x; presentY = y; presentW = w; presentH = h;
+}
+
+static unsigned long transMaxFrameUs = 0;   // worst transition frame so far
+static Screen        powerScreenUi   = SCREEN_HOME;   // what Diagnostics reports on
+
+static const char* moodTextLocal(Mood m) {
+    switch (m) {
+        case MOOD_HUNGRY:  return "HUNGRY";
+        case MOOD_HAPPY:   return "HAPPY";
+        case MOOD_CURIOUS: return "CURIOUS";
+        case MOOD_BORED:   return "BORED";
+        case MOOD_SICK:    return "SICK";
+        case MOOD_EXCITED: return "EXCITED";
+        case MOOD_CALM:    return "CALM";
+    }
+    return "?";
+}
+
+static const char* stageTextLocal(Stage s) {
+    switch (s) {
+        case STAGE_BABY:  return "BABY";
+        case STAGE_TEEN:  return "TEEN";
+        case STAGE_ADULT: return "ADULT";
+        case STAGE_ELDER: return "ELDER";
+    }
+    return "?";
+}
+
+static const char* activityTextLocal(Activity a) {
+    switch (a) {
+        case ACT_HUNT:     return "HUNTING WIFI...";
+        case ACT_DISCOVER: return "DISCOVERING...";
+        case ACT_REST:     return "RESTING...";
+        default:           return "";
+    }
+}
+
+static const char* screenTextLocal(Screen s) {
+    switch (s) {
+        case SCREEN_BOOT:        return "BOOT";
+        case SCREEN_HATCH:       return "HATCH";
+        case SCREEN_HOME:        return "HOME";
+        case SCREEN_MENU:        return "MENU";
+        case SCREEN_PET_STATUS:  return "PET STATUS";
+        case SCREEN_ENVIRONMENT: return "ENVIRONMENT";
+        case SCREEN_SYSINFO:     return "SYSINFO";
+        case SCREEN_CONTROLS:    return "CONTROLS";
+        case SCREEN_SETTINGS:    return "SETTINGS";
+        case SCREEN_DIAGNOSTICS: return "DIAGNOSTICS";
+        case SCREEN_GAMEOVER:    return "GAME OVER";
+    }
+    return "?";
+}
+
+static void drawHeader(const char* title) {
+    fb.fillRect(0, 0, TFT_W, 18, TFT_BLACK);
+    fb.drawLine(0, 18, TFT_W, 18, TFT_CYAN);
+    fb.drawLine(0, 19, TFT_W, 19, TFT_MAGENTA);
+
+    fb.fillRect(5, 6, 6, 6, TFT_WHITE);
+    fb.fillRect(6, 7, 4, 4, TFT_BLACK);
+
+    stampPrint(fb, 18, 5, title, TFT_WHITE);
+}
+
+static void drawBar(int x, int y, int w, int h, int value, uint16_t color) {
+    fb.drawRect(x, y, w, h, TFT_WHITE);
+    int fillWidth = (w - 2) * value / 100;
+    fb.fillRect(x + 1, y + 1, fillWidth, h - 2, color);
+}
+
+// Icon stamp ids (text stamps are keyed by string)
+enum {
+    STAMP_MENU_ICON   = 0x100,    // + icon index
+    STAMP_BUBBLE_DISK = 0x200,
+    STAMP_BUBBLE_CORE,
+    STAMP_BUBBLE_RING
+};
+
+// Painters draw in colour 1 relative to (0,0); colour is applied on expand
+static void paintBubble(TFT_eSprite& s, int kind) {
+    switch (kind) {
+        case STAMP_BUBBLE_DISK: s.fillCircle(4, 4, 4, TFT_WHITE); break;
+        case STAMP_BUBBLE_CORE: s.fillCircle(4, 4, 2, TFT_WHITE); break;
+        case STAMP_BUBBLE_RING: s.drawCircle(4, 4, 4, TFT_WHITE); break;
+    }
+}
+
+static void drawBubble(int x, int y, bool selected) {
+    if (selected) {
+        stampDraw(fb, stampIcon(STAMP_BUBBLE_DISK, 9, 9, paintBubble, STAMP_BUBBLE_DISK),
+                  x - 4, y - 4, TFT_WHITE);
+        stampDraw(fb, stampIcon(STAMP_BUBBLE_CORE, 9, 9, paintBubble, STAMP_BUBBLE_CORE),
+                  x - 4, y - 4, TFT_BLACK);
+    } else {
+        stampDraw(fb, stampIcon(STAMP_BUBBLE_RING, 9, 9, paintBubble, STAMP_BUBBLE_RING),
+                  x - 4, y - 4, TFT_WHITE);
+    }
+}
+
+static void paintMenuIcon(TFT_eSprite& s, int iconIndex) {
+    const int x = 0, y = 0;
+    switch (iconIndex) {
+        case 0: s.drawRect(x, y+3, 5, 4, TFT_WHITE); s.fillRect(x+1,y+4,3,2,TFT_WHITE); break;
+        case 1: s.drawLine(x+2,y+8,x+5,y+2,TFT_WHITE); s.drawLine(x+8,y+8,x+5,y+2,TFT_WHITE); s.fillRect(x+4,y+8,2,3,TFT_WHITE); break;
+        case 2: s.drawRect(x+1,y+2,8,6,TFT_WHITE); s.drawPixel(x,y+3,TFT_WHITE); s.drawPixel(x+9,y+3,TFT_WHITE); break;
+        case 3: s.drawLine(x+1,y+3,x+9,y+3,TFT_WHITE); s.fillRect(x+3,y+2,3,3,TFT_WHITE); break;
+        case 4: s.drawCircle(x+5,y+5,3,TFT_WHITE); break;
+        case 5: s.fillRect(x+4,y+2,2,2,TFT_WHITE); break;
+        case 6: s.drawLine(x+8,y+4,x+2,y+4,TFT_WHITE); s.drawLine(x+2,y+4,x+4,y+2,TFT_WHITE); break;
+    }
+}
+
+static void drawMenuIcon(int iconIndex, int x, int y) {
+    stampDraw(fb, stampIcon(STAMP_MENU_ICON + iconIndex, 10, 11, paintMenuIcon, iconIndex),
+              x, y, TFT_WHITE);
+}
+
+static void animateSelector(int &pos, int &target, TimeMs &lastTick) {
+    TimeMs now = monoMs();
+    if (now - lastTick < MENU_ANIM_INTERVAL) return;
+    lastTick = now;
+    if (pos == target) return;
+
+    int diff = target - pos;
+    int step = (diff > 0) ? MENU_ANIM_STEP : -MENU_ANIM_STEP;
+    if (abs(diff) < MENU_ANIM_STEP) pos = target;
+    else pos += step;
+}
+
+static int idleFrameDelay() {
+    if (snap.mood == MOOD_EXCITED) return IDLE_FAST_DELAY;
+    if (snap.mood == MOOD_BORED || snap.mood == MOOD_SICK) return IDLE_SLOW_DELAY;
+    return IDLE_BASE_DELAY;
+}
+
+static const uint16_t** currentIdleSet() {
+    switch (snap.stage) {
+        case STAGE_BABY:  return BABY_IDLE_FRAMES;
+        case STAGE_TEEN:  return TEEN_IDLE_FRAMES;
+        case STAGE_ADULT: return ADULT_IDLE_FRAMES;
+        case STAGE_ELDER: return ELDER_IDLE_FRAMES;
+    }
+    return BABY_IDLE_FRAMES;
+}
+
+// ---------------------------------------------------------------------------
+// BOOT SCREEN
+// ---------------------------------------------------------------------------
+static void screenBoot() {
+    fb.fillSprite(TFT_BLACK);
+    drawHeader("TamaFi v2");
+
+    fb.setTextColor(TFT_WHITE);
+    fb.setCursor(20, 60);
+    fb.print("WiFi-fed Virtual Pet");
+
+    fb.setCursor(20, 100);
+    fb.print("Press any button...");
+}
+
+// ---------------------------------------------------------------------------
+// HATCH SCREEN (Idle egg → OK → hatch → home)
+// ---------------------------------------------------------------------------
+static void screenHatch() {
+    TimeMs now = monoMs();
+
+    const uint16_t* frame;
+
+    // 1) Idle egg animation until OK pressed
+    if (!snap.hatchTriggered) {
+        if (now - lastEggIdleTimeUi >= EGG_IDLE_DELAY) {
+            lastEggIdleTimeUi = now;
+            eggIdleFrameUi = (eggIdleFrameUi + 1) % 4;
+        }
+
+        frame = EGG_IDLE_FRAMES[eggIdleFrameUi];
+    }
+
+    // 2) Triggered hatch animation
+    else {
+        if (now - lastHatchFrameUi >= HATCH_DELAY) {
+            lastHatchFrameUi = now;
+
+            // Last frame stays up until the logic side switches to HOME
+            if (hatchFrameUi < 4) hatchFrameUi++;
+            else uiHatchFinished();
+        }
+
+        frame = EGG_FRAMES[hatchFrameUi];
+    }
+
+    // Compose only after the screen-switch checks above, so fb still holds
+    // the last shown frame if a transition snapshots it
+    fb.fillSprite(TFT_BLACK);
+    drawHeader("Hatching...");
+    fb.pushImage(0, 18, TFT_W, TFT_H - 18, backgroundImage2);
+
+    petSprite.pushImage(0, 0, PET_W, PET_H, frame);
+    petSprite.pushToSprite(&fb, 70, 80, TFT_WHITE);
+}
+
+// ---------------------------------------------------------------------------
+// HOME SCREEN
+// ---------------------------------------------------------------------------
+
+// Everything on the home screen except the pet is static between stat
+// changes, so fb keeps header + background + stats from the last full
+// compose and only the pet rectangle is redrawn and pushed per frame.
+struct HudKey {
+    int      hunger;
+    int      happiness;
+    int      health;
+    Mood     mood;
+    Stage    stage;
+    Activity activity;
+};
+
+static HudKey hudKey;
+static bool   hudValid = false;
+
+static bool hudNeedsRebuild() {
+    HudKey k = { snap.pet.hunger, snap.pet.happiness, snap.pet.health,
+                 snap.mood, snap.stage, snap.activity };
+
+    bool changed = !hudValid ||
+                   k.hunger    != hudKey.hunger    ||
+                   k.happiness != hudKey.happiness ||
+                   k.health    != hudKey.health    ||
+                   k.mood      != hudKey.mood      ||
+                   k.stage     != hudKey.stage     ||
+                   k.activity  != hudKey.activity;
+
+    hudKey = k;
+    return changed;
+}
+
+// Repaint the background only inside the given rectangle
+static void restoreBackground(int x, int y, int w, int h) {
+    fb.setViewport(x, y, w, h, false);
+    fb.pushImage(0, 18, TFT_W, TFT_H - 18, backgroundImage);
+    fb.resetViewport();
+}
+
+static void drawStatsBlock() {
+    int x = 20, y = 100, w = 80, h = 8;
+
+    drawBar(x, y,       w, h, snap.pet.hunger,    TFT_RED);
+    drawBar(x, y + 28,  w, h, snap.pet.happiness, TFT_YELLOW);
+    drawBar(x, y + 56,  w, h, snap.pet.health,    TFT_GREEN);
+
+    fb.setTextColor(TFT_BLACK);
+    fb.setCursor(x + 3, y + 75);
+    fb.print("Mood:  ");
+    fb.print(moodTextLocal(snap.mood));
+
+    fb.setCursor(x + 3, y + 89);
+    fb.print("Stage: ");
+    fb.print(stageTextLocal(snap.stage));
+}
+
+static void drawPetFrame(const uint16_t* frame) {
+    petSprite.pushImage(0, 0, PET_W, PET_H, frame);
+    petSprite.pushToSprite(&fb, petPosX, petPosY, TFT_WHITE);
+}
+
+static void screenHome() {
+    bool fullFrame = hudNeedsRebuild();
+
+    if (fullFrame) {
+        fb.fillSprite(TFT_BLACK);
+
+        // ===== TOP BAR MESSAGE =====
+        if (snap.activity != ACT_NONE)
+            drawHeader(activityTextLocal(snap.activity));
+        else
+            drawHeader("Idle");
+
+        fb.pushImage(0, 18, TFT_W, TFT_H - 18, backgroundImage);
+        drawStatsBlock();
+        hudValid = true;
+    } else {
+        restoreBackground(petPosX, petPosY, PET_W, PET_H);
+    }
+
+    TimeMs now = monoMs();
+
+    // =============================
+    //        REST ANIMATION
+    // =============================
+    if (snap.activity == ACT_REST && snap.restPhase != REST_NONE) {
+
+        int frameIdx = 0;
+
+        if (snap.restPhase == REST_ENTER) {
+            // Going to sleep → 5 → 4 → 3 → 2 → 1
+            frameIdx = 4 - constrain(snap.restFrameIndex, 0, 4);
+        }
+        else if (snap.restPhase == REST_DEEP) {
+            // Deep sleeping → always frame 1 (egg_hatch_1)
+            frameIdx = 0;
+        }
+        else if (snap.restPhase == REST_WAKE) {
+            // Waking up → 1 → 2 → 3 → 4 → 5
+            frameIdx = constrain(snap.restFrameIndex, 0, 4);
+        }
+
+        drawPetFrame(EGG_FRAMES[frameIdx]);
+    }
+
+    // =============================
+    //        HUNTING ANIMATION
+    // =============================
+    else if (snap.activity == ACT_HUNT) {
+
+        if (now - lastHuntFrameTime >= HUNT_FRAME_DELAY) {
+            lastHuntFrameTime = now;
+            huntFrame = (huntFrame + 1) % 3;   // attack_0 → attack_1 → attack_2
+        }
+
+        drawPetFrame(ATTACK_FRAMES[huntFrame]);
+    }
+
+    // =============================
+    //        IDLE ANIMATION
+    // =============================
+    else {
+        if (now - lastIdleFrameUi >= idleFrameDelay()) {
+            lastIdleFrameUi = now;
+            idleFrameUi = (idleFrameUi + 1) % 4;
+        }
+
+        const uint16_t** idleSet = currentIdleSet();
+        drawPetFrame(idleSet[idleFrameUi]);
+
+        // =============================
+        //     HUNGER EFFECT OVERLAY
+        // =============================
+        // (lies inside the pet rectangle, so the partial push covers it)
+        if (snap.hungerEffectActive) {
+            effectSprite.pushImage(0, 0, EFFECT_W, EFFECT_H, HUNGER_FRAMES[snap.hungerEffectFrame]);
+            effectSprite.pushToSprite(&fb, 120, 90, TFT_WHITE);
+        }
+    }
+
+    if (!fullFrame)
+        setPresentRect(petPosX, petPosY, PET_W, PET_H);
+}
+
+
+// ---------------------------------------------------------------------------
+// MENUS (main, controls, settings) - layout comes from the tables in menu.h
+// ---------------------------------------------------------------------------
+static void screenMenu(const MenuDef& m) {
+    fb.fillSprite(TFT_BLACK);
+    drawHeader(m.title);
+
+    animateSelector(menuHighlightY, menuHighlightTargetY, lastMenuAnimTime);
+
+    fb.fillRect(MENU_HILITE_X, menuHighlightY, MENU_HILITE_W, MENU_HILITE_H, TFT_DARKGREY);
+    fb.drawRect(MENU_HILITE_X, menuHighlightY, MENU_HILITE_W, MENU_HILITE_H, TFT_CYAN);
+
+    for (int i = 0; i < m.count; i++) {
+        const MenuItem& item = m.items[i];
+        bool selected = (i == snap.*m.shownCursor);
+        int  y = m.textY(i);
+
+        if (m.style == MENU_ICONS) drawMenuIcon(i, MENU_ICON_X, y - 2);
+        else                       drawBubble(MENU_BUBBLE_X, y + MENU_BUBBLE_LIFT, selected);
+
+        stampPrint(fb, m.labelX(), y, item.label, selected ? TFT_YELLOW : TFT_WHITE);
+
+        if (item.value) {
+            char buf[8];
+            stampPrint(fb, MENU_VALUE_X, y, item.value(snap, buf, sizeof(buf)), TFT_CYAN);
+        }
+    }
+
+    stampPrint(fb, MENU_FOOTER_X, MENU_FOOTER_Y, m.footer, m.footerColor);
+}
+
+// ---------------------------------------------------------------------------
+// PET STATUS
+// ---------------------------------------------------------------------------
+static void screenPetStatus() {
+    fb.fillSprite(TFT_BLACK);
+    drawHeader("Pet Status");
+
+    fb.setTextColor(TFT_WHITE);
+
+    fb.setCursor(10, 26);
+    fb.print("Stage: ");  fb.print(stageTextLocal(snap.stage));
+
+    fb.setCursor(10,38);
+    fb.print("Age:   ");
+    fb.print(snap.pet.ageDays); fb.print("d ");
+    fb.print(snap.pet.ageHours); fb.print("h ");
+    fb.print(snap.pet.ageMinutes); fb.print("m");
+
+
+    fb.setCursor(10, 56);
+    fb.print("Hunger: "); fb.print(snap.pet.hunger); fb.print("%");
+
+    fb.setCursor(10, 68);
+    fb.print("Happy:  "); fb.print(snap.pet.happiness); fb.print("%");
+
+    fb.setCursor(10, 80);
+    fb.print("Health: "); fb.print(snap.pet.health); fb.print("%");
+
+    fb.setCursor(10, 98);
+    fb.print("Mood:   "); fb.print(moodTextLocal(snap.mood));
+
+    fb.setCursor(10, 116);
+    fb.print("Personality:");
+
+    fb.setCursor(16, 130);
+    fb.print("Curiosity: "); fb.print((int)snap.traitCuriosity);
+
+    fb.setCursor(16, 142);
+    fb.print("Activity : "); fb.print((int)snap.traitActivity);
+
+    fb.setCursor(16, 154);
+    fb.print("Stress   : "); fb.print((int)snap.traitStress);
+
+    fb.setCursor(10, 200);
+    fb.print("OK = Back");
+}
+
+// ---------------------------------------------------------------------------
+// ENVIRONMENT
+// ---------------------------------------------------------------------------
+static void screenEnvironment() {
+    fb.fillSprite(TFT_BLACK);
+    drawHeader("Environment");
+
+    fb.setTextColor(TFT_WHITE);
+
+    fb.setCursor(10, 30);
+    fb.print("Networks : "); fb.print(snap.wifi.netCount);
+
+    fb.setCursor(10, 42);
+    fb.print("Strong   : "); fb.print(snap.wifi.strongCount);
+
+    fb.setCursor(10, 54);
+    fb.print("Hidden   : "); fb.print(snap.wifi.hiddenCount);
+
+    fb.setCursor(10, 66);
+    fb.print("Open     : "); fb.print(snap.wifi.openCount);
+
+    fb.setCursor(10, 78);
+    fb.print("WPA/etc  : "); fb.print(snap.wifi.wpaCount);
+
+    fb.setCursor(10, 94);
+    fb.print("Avg RSSI : "); fb.print(snap.wifi.avgRSSI);
+
+    fb.setCursor(10, 200);
+    fb.print("OK = Back");
+}
+
+// ---------------------------------------------------------------------------
+// SYSTEM INFO
+// ---------------------------------------------------------------------------
+static void screenSysInfo() {
+    fb.fillSprite(TFT_BLACK);
+    drawHeader("System Info");
+
+    fb.setTextColor(TFT_WHITE);
+
+    fb.setCursor(10, 30);
+    fb.print("Firmware: 2.0");
+
+    fb.setCursor(10, 42);
+    fb.print("MCU:      ESP32");
+
+    fb.setCursor(10, 54);
+    fb.print("Heap Free: ");
+    fb.print((uint32_t)traceValue(TRACE_ENV, ESP.getFreeHeap()) / 1024); fb.print(" KB");
+
+    unsigned long s = (unsigned long)(monoMs() / 1000);
+    unsigned long m = s / 60;
+    unsigned long h = m / 60;
+    s %= 60; m %= 60;
+
+    fb.setCursor(10, 72);
+    fb.print("Uptime: ");
+    fb.printf("%02lu:%02lu:%02lu", h, m, s);
+
+    fb.setCursor(10, 90);
+    fb.print("WiFi Scan: ");
+    fb.print(snap.wifiScanInProgress ? "Running" : "Idle");
+
+    fb.setCursor(10, 200);
+    fb.print("OK = Back");
+}
+
+// ---------------------------------------------------------------------------
+// DIAGNOSTICS
+// ---------------------------------------------------------------------------
+static void screenDiagnostics() {
+    fb.fillSprite(TFT_BLACK);
+    drawHeader("Diagnostics");
+
+    fb.setTextColor(TFT_WHITE);
+
+    fb.setCursor(10, 30);
+    fb.print("Activity: ");
+    fb.print(activityTextLocal(snap.activity));
+
+    fb.setCursor(10, 42);
+    fb.print("Mood: ");
+    fb.print(moodTextLocal(snap.mood));
+
+    fb.setCursor(10, 54);
+    fb.print("RestPhase: ");
+    fb.print(snap.restPhase==REST_ENTER?"ENTER":
+             snap.restPhase==REST_DEEP ?"DEEP":
+             snap.restPhase==REST_WAKE ?"WAKE":"NONE");
+
+    fb.setCursor(10, 66);
+    fb.print("WiFi Scan: ");
+    fb.print(snap.wifiScanInProgress?"Running":"Idle");
+
+    fb.setCursor(10, 78);
+    fb.print("Transition: ");
+    fb.print(transMaxFrameUs / 1000); fb.print(" ms max");
+
+    fb.setCursor(10, 90);
+    fb.print("Snapshot retries: ");
+    fb.print(snapRetries);
+
+    // Power figures for the screen Diagnostics was opened from
+    PowerReport pr = powerReport(powerScreenUi);
+    float span = pr.spanMs ? (float)pr.spanMs : 1.0f;
+
+    fb.setCursor(10, 108);
+    fb.print("Power on ");
+    fb.print(screenTextLocal(powerScreenUi));
+    fb.print(traceValue(TRACE_ENV, powerLightSleepAvailable()) ? " (light sleep)" : " (idle wait)");
+
+    fb.setCursor(10, 120);
+    fb.printf("Duty: logic %.1f%%  render %.1f%%",
+              100.0f * pr.busyMs[POWER_LOGIC] / span, 100.0f * pr.busyMs[POWER_RENDER] / span);
+
+    fb.setCursor(10, 132);
+    fb.printf("Wakes/min: logic %lu  render %lu",
+              (unsigned long)(pr.wakes[POWER_LOGIC] * 60000.0f / span),
+              (unsigned long)(pr.wakes[POWER_RENDER] * 60000.0f / span));
+
+    fb.setCursor(10, 144);
+    fb.printf("Mood evals: %lu run, %lu saved",
+              (unsigned long)snap.evals.moodRuns, (unsigned long)snap.evals.moodSaved);
+
+    if (snap.timeScale > 1) {
+        fb.setCursor(10, 162);
+        fb.setTextColor(TFT_YELLOW);
+        fb.printf("Pet time: x%u", (unsigned)snap.timeScale);
+        fb.setTextColor(TFT_WHITE);
+    }
+
+    fb.setCursor(10, 200);
+    fb.print("OK = Back");
+}
+
+// ---------------------------------------------------------------------------
+// GAME OVER
+// ---------------------------------------------------------------------------
+static void screenGameOver() {
+    fb.fillSprite(TFT_BLACK);
+    drawHeader("Game Over");
+
+    TimeMs now = monoMs();
+    if (now - lastDeadFrameUi >= DEAD_DELAY) {
+        lastDeadFrameUi = now;
+        //deadFrameUi = (deadFrameUi + 1) % DEAD_FRAME_COUNT;
+        deadFrameUi++;
+        if (deadFrameUi > 2) deadFrameUi = 2;
+    }
+
+    fb.pushImage(0, 18, TFT_W, TFT_H - 18, backgroundImage);
+
+    petSprite.pushImage(0, 0, PET_W, PET_H, DEAD_FRAMES[deadFrameUi]);
+    petSprite.pushToSprite(&fb, petPosX, petPosY, TFT_WHITE);
+
+    //fb.setCursor(10, 200);
+    //fb.setTextColor(TFT_WHITE);
+    //fb.print("OK = Restart");
+}
+
+// ---------------------------------------------------------------------------
+// SCREEN TRANSITIONS
+// ---------------------------------------------------------------------------
+//  SLIDE : outgoing rows are shifted sideways inside fb and the incoming
+//          screen is drawn into the uncovered strip through a viewport.
+//  WIPE  : incoming screen is drawn in full; only the newly revealed band of
+//          rows is pushed, the panel still shows the rest of the old screen.
+//  FADE  : outgoing frame is kept in prevFrame and blended over the incoming
+//          one. Needs a second 240x240 buffer; falls back to WIPE without it.
+//
+// Every transition frame pushes at most transitionBudgetRows() rows. When
+// the whole screen changes (slide/fade) rows are pushed interlaced, so each
+// frame stays inside TRANSITION_FRAME_MS and the loop keeps handling input.
+
+#ifndef SPI_FREQUENCY
+#define SPI_FREQUENCY 27000000
+#endif
+
+enum TransitionKind {
+    TRANS_NONE,
+    TRANS_SLIDE_LEFT,     // incoming enters from the right
+    TRANS_SLIDE_RIGHT,    // incoming enters from the left
+    TRANS_WIPE_DOWN,
+    TRANS_FADE
+};
+
+static TFT_eSprite prevFrame(&tft);
+
+static TransitionKind transKind   = TRANS_NONE;
+static Screen         shownScreen = SCREEN_BOOT;
+static TimeMs         transStart  = 0;
+static int            transOffset = 0;       // slide/wipe progress in pixels
+static int            transPhase  = 0;       // interlace row phase
+static int            transSettle = 0;       // frames left after progress hit 100%
+
+
+static int transitionBudgetRows() {
+    // 16 bits per pixel on the wire, leave a quarter of the frame for compose
+    const uint32_t pxPerMs = SPI_FREQUENCY / 16 / 1000;
+    uint32_t rows = (TRANSITION_FRAME_MS * 3 / 4) * pxPerMs / TFT_W;
+    return constrain((int)rows, 1, TFT_H);
+}
+
+static int screenDepth(Screen s) {
+    switch (s) {
+        case SCREEN_HOME: return 0;
+        case SCREEN_MENU: return 1;
+        default:          return 2;
+    }
+}
+
+static TransitionKind transitionFor(Screen from, Screen to) {
+    if (from == SCREEN_BOOT || from == SCREEN_HATCH || to == SCREEN_GAMEOVER ||
+        to == SCREEN_HATCH)
+        return TRANS_FADE;
+
+    // HOME hotkeys straight into a page (and back) skip the menu level
+    if (abs(screenDepth(to) - screenDepth(from)) > 1)
+        return TRANS_WIPE_DOWN;
+
+    return screenDepth(to) > screenDepth(from) ? TRANS_SLIDE_LEFT : TRANS_SLIDE_RIGHT;
+}
+
+static void startTransition(Screen from, Screen to) {
+    TransitionKind kind = transitionFor(from, to);
+
+    if (kind == TRANS_FADE) {
+        if (!prevFrame.created()) {
+            prevFrame.setColorDepth(16);
+            prevFrame.createSprite(TFT_W, TFT_H);
+        }
+        if (prevFrame.created()) {
+            // fb still holds what is on the panel (or the interrupted composite)
+            memcpy(prevFrame.getPointer(), fb.getPointer(), TFT_W * TFT_H * 2);
+        } else {
+            kind = TRANS_WIPE_DOWN;
+        }
+    }
+
+    transKind   = kind;
+    transStart  = monoMs();
+    transOffset = 0;
+    transPhase  = 0;
+    transSettle = 0;
+}
+
+// Push every row in [y0, y1) whose index matches the interlace phase
+static void pushRows(int y0, int y1, int stride, int phase) {
+    for (int y = y0; y < y1; y++) {
+        if (stride > 1 && (y % stride) != phase) continue;
+        int run = 1;
+        if (stride == 1) run = y1 - y;
+        fb.pushSprite(0, y, 0, y, TFT_W, run);
+        y += run - 1;
+    }
+}
+
+static void composeScreen(Screen screen);
+
+static void transitionFrame(Screen screen) {
+    TimeUs t0 = monoUs();
+    TimeMs elapsed = monoMs() - transStart;
+    int target = (int)min<TimeMs>(elapsed * TFT_W / TRANSITION_MS, TFT_W);
+    int rows   = (int)min<TimeMs>(elapsed * TFT_H / TRANSITION_MS, TFT_H);
+
+    int budgetRows = transitionBudgetRows();
+    int stride     = (TFT_H + budgetRows - 1) / budgetRows;
+    uint16_t* px   = (uint16_t*)fb.getPointer();
+
+    hudValid = false;   // home must compose in full while fb is shared
+
+    switch (transKind) {
+        case TRANS_SLIDE_LEFT:
+        case TRANS_SLIDE_RIGHT: {
+            int d = target - transOffset;
+            if (d > 0) {
+                int keep = TFT_W - target;   // outgoing columns still visible
+                for (int y = 0; y < TFT_H; y++) {
+                    uint16_t* row = px + y * TFT_W;
+                    if (transKind == TRANS_SLIDE_LEFT)
+                        memmove(row, row + d, keep * 2);
+                    else
+                        memmove(row + target, row + transOffset, keep * 2);
+                }
+            }
+            transOffset = target;
+
+            int originX = (transKind == TRANS_SLIDE_LEFT) ? TFT_W - target : target - TFT_W;
+            fb.setViewport(originX, 0, TFT_W, TFT_H, true);
+            composeScreen(screen);
+            fb.resetViewport();
+
+            pushRows(0, TFT_H, stride, transPhase);
+            break;
+        }
+
+        case TRANS_WIPE_DOWN: {
+            composeScreen(screen);
+
+            int to = min(rows, transOffset + budgetRows);
+            pushRows(transOffset, to, 1, 0);
+            transOffset = to;
+            break;
+        }
+
+        case TRANS_FADE: {
+            composeScreen(screen);
+
+            uint8_t alpha = (uint8_t)(RGB565_ALPHA_MAX - target * RGB565_ALPHA_MAX / TFT_W);
+            rgb565Blend(px, (const uint16_t*)prevFrame.getPointer(), TFT_W * TFT_H, alpha, true);
+            transOffset = target;
+
+            pushRows(0, TFT_H, stride, transPhase);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    transPhase = (transPhase + 1) % stride;
+
+    // Once at 100%, keep pushing interlaced fields until every row is current
+    bool done = (transKind == TRANS_WIPE_DOWN) ? transOffset >= TFT_H : transOffset >= TFT_W;
+    if (done) {
+        int fields = (transKind == TRANS_WIPE_DOWN) ? 1 : stride;
+        if (++transSettle >= fields) {
+            transKind = TRANS_NONE;
+            hudValid  = false;
+        }
+    }
+
+    unsigned long dt = (unsigned long)(monoUs() - t0);
+    if (dt > transMaxFrameUs) transMaxFrameUs = dt;
+}
+
+// ---------------------------------------------------------------------------
+// PUBLIC UI API
+// ---------------------------------------------------------------------------
+void uiInit() {
+    stampInit();
+
+    idleFrameUi = 0;
+    lastIdleFrameUi = monoMs();
+
+    eggIdleFrameUi = 0;
+    lastEggIdleTimeUi = monoMs();
+
+    hatchFrameUi = 0;
+    lastHatchFrameUi = monoMs();
+
+    deadFrameUi = 0;
+    lastDeadFrameUi = monoMs();
+}
+
+// The snapshot shows a different screen than the panel does
+static void uiOnScreenChange(Screen newScreen) {
+    hudValid = false;   // other screens overwrite fb
+
+    if (newScreen == SCREEN_DIAGNOSTICS) powerScreenUi = shownScreen;
+
+    startTransition(shownScreen, newScreen);
+    shownScreen = newScreen;
+
+    if (const MenuDef* m = menuFor(newScreen)) {
+        menuHighlightY = menuHighlightTargetY = m->highlightY(snap.*m->shownCursor);
+    }
+    if (newScreen == SCREEN_HATCH) {
+        eggIdleFrameUi = hatchFrameUi = 0;
+    }
+}
+
+// Animations that start with a pet event run from the moment it happened
+static void uiHandleEvents() {
+    PetEvent ev;
+    while (tracePollBus(BUS_UI, ev)) {
+        switch (ev.type) {
+            case EV_HATCH_STARTED:
+                hatchFrameUi     = 0;
+                lastHatchFrameUi = ev.at / 1000;
+                break;
+            case EV_DIED:
+                deadFrameUi     = 0;
+                lastDeadFrameUi = ev.at / 1000;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void uiDrawScreen()
+{
+    if (readSnapshot(snap) > 1) snapRetries++;
+    uiHandleEvents();
+
+    Screen screen = snap.screen;
+    if (screen != shownScreen) uiOnScreenChange(screen);
+
+    if (const MenuDef* m = menuFor(screen)) {
+        menuHighlightTargetY = m->highlightY(snap.*m->shownCursor);
+    }
+
+    setPresentRect(0, 0, TFT_W, TFT_H);
+
+    if (transKind != TRANS_NONE) {
+        transitionFrame(screen);
+        return;
+    }
+
+    composeScreen(screen);
+
+    fb.pushSprite(presentX, presentY, presentX, presentY, presentW, presentH);
+}
+
+Screen uiShownScreen() {
+    return shownScreen;
+}
+
+// Frames only change on a new snapshot (the logic side kicks the render
+// task) or when one of the animations below is due
+uint32_t uiIdleMs() {
+    if (transKind != TRANS_NONE) return 0;
+
+    TimeMs now = monoMs();
+    uint32_t ms = NO_DEADLINE;
+
+    if (menuFor(shownScreen) && menuHighlightY != menuHighlightTargetY)
+        ms = msUntil(now, lastMenuAnimTime + MENU_ANIM_INTERVAL);
+
+    switch (shownScreen) {
+        case SCREEN_HATCH:
+            if (!snap.hatchTriggered) ms = min(ms, msUntil(now, lastEggIdleTimeUi + EGG_IDLE_DELAY));
+            else                      ms = min(ms, msUntil(now, lastHatchFrameUi + HATCH_DELAY));
+            break;
+
+        case SCREEN_HOME:
+            if (snap.activity == ACT_REST && snap.restPhase != REST_NONE) break;   // frames come from logic
+            if (snap.activity == ACT_HUNT) ms = min(ms, msUntil(now, lastHuntFrameTime + HUNT_FRAME_DELAY));
+            else                           ms = min(ms, msUntil(now, lastIdleFrameUi + idleFrameDelay()));
+            break;
+
+        case SCREEN_SYSINFO:
+        case SCREEN_DIAGNOSTICS:
+            ms = min<uint32_t>(ms, 1000 - now % 1000);   // uptime / counters
+            break;
+
+        case SCREEN_GAMEOVER:
+            if (deadFrameUi < 2) ms = min(ms, msUntil(now, lastDeadFrameUi + DEAD_DELAY));
+            break;
+
+        default:
+            break;
+    }
+    return ms;
+}
+
+static void composeScreen(Screen screen) {
+    switch (screen) {
+        case SCREEN_BOOT:        screenBoot(); break;
+        case SCREEN_HATCH:       screenHatch(); break;
+        case SCREEN_HOME:        screenHome(); break;
+        case SCREEN_MENU:        screenMenu(MAIN_MENU); break;
+        case SCREEN_PET_STATUS:  screenPetStatus(); break;
+        case SCREEN_ENVIRONMENT: screenEnvironment(); break;
+        case SCREEN_SYSINFO:     screenSysInfo(); break;
+        case SCREEN_CONTROLS:    screenMenu(CONTROLS_MENU); break;
+        case SCREEN_SETTINGS:    screenMenu(SETTINGS_MENU); break;
+        case SCREEN_DIAGNOSTICS: screenDiagnostics(); break;
+        case SCREEN_GAMEOVER:    screenGameOver(); break;
+    }
+}
@@ -1,134 +1,106 @@
-#pragma once
-#include <Arduino.h>
-#include <TFT_eSPI.h>
-
-// ============ Enums & structs shared between UI and main ============
-
-void sndHatch();
-
-int petPosX = 120;
-int petPosY = 90;
-
-enum Screen {
-  SCREEN_BOOT,
-  SCREEN_HATCH,
-  SCREEN_HOME,
-  SCREEN_MENU,
-  SCREEN_PET_STATUS,
-  SCREEN_ENVIRONMENT,
-  SCREEN_SYSINFO,
-  SCREEN_CONTROLS,
-  SCREEN_SETTINGS,
-  SCREEN_DIAGNOSTICS,
-  SCREEN_GAMEOVER
-};
-
-enum Activity {
-  ACT_NONE,
-  ACT_HUNT,
-  ACT_DISCOVER,
-  ACT_REST
-};
-
-enum Stage {
-  STAGE_BABY = 0,
-  STAGE_TEEN = 1,
-  STAGE_ADULT = 2,
-  STAGE_ELDER = 3
-};
-
-enum Mood {
-  MOOD_HUNGRY,
-  MOOD_HAPPY,
-  MOOD_CURIOUS,
-  MOOD_BORED,
-  MOOD_SICK,
-  MOOD_EXCITED,
-  MOOD_CALM
-};
-
-enum RestPhase {
-  REST_NONE,
-  REST_ENTER,
-  REST_DEEP,
-  REST_WAKE
-};
-
-struct Pet {
-  int hunger;
-  int happiness;
-  int health;
-
-  unsigned long ageMinutes;
-  unsigned long ageHours;
-  unsigned long ageDays;
-};
-
-struct WifiStats {
-  int netCount    = 0;
-  int strongCount = 0;
-  int hiddenCount = 0;
-  int avgRSSI     = -100;
-  int openCount   = 0;
-  int wpaCount    = 0;
-};
-
-// ============ Extern objects from main (TFT & sprites) ============
-
-extern TFT_eSPI tft;
-extern TFT_eSprite fb;
-extern TFT_eSprite petSprite;
-extern TFT_eSprite effectSprite;
-
-// ============ Shared game state (defined in TamaFi.ino) ============
-
-extern Screen    currentScreen;
-extern Activity  currentActivity;
-extern RestPhase restPhase;
-
-extern Pet       pet;
-extern WifiStats wifiStats;
-
-extern Mood      currentMood;
-extern Stage     petStage;
-
-extern bool      hungerEffectActive;
-extern int       hungerEffectFrame;
-extern bool      hasHatchedOnce;
-
-extern bool      wifiScanInProgress;
-extern unsigned long lastWifiScanTime;
-extern unsigned long lastSaveTime;
-
-extern bool      soundEnabled;
-extern bool      neoPixelsEnabled;
-extern uint8_t   tftBrightnessIndex;
-extern uint8_t   ledBrightnessIndex;
-extern bool      autoSleep;
-extern uint16_t  autoSaveMs;
-
-extern uint8_t   traitCuriosity;
-extern uint8_t   traitActivity;
-extern uint8_t   traitStress;
-
-extern unsigned long lastDecisionTime;
-extern uint32_t      currentDecisionInterval;
-
-extern int       restFrameIndex;
-
-// menus (main file owns, UI reads)
-extern int       mainMenuIndex;
-extern int       controlsIndex;
-extern int       settingsMenuIndex;
-
-// Hatch trigger: main sets true on OK, UI consumes it
-extern bool      hatchTriggered;
-
-// ============ UI API ============
-
-void uiInit();                                      // Call in setup()
-void uiOnScreenChange(Screen newScreen);            // Call whenever currentScreen changes
-void uiDrawScreen(Screen screen,
-                  int mainMenuIndex,
-                  int controlsIndex,
-                  int settingsMenuIndex);           // Call every loop after logic/buttons
+#pragma once
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include "monotonic.h"
+#include "pet_sim.h"
+
+// ============ Enums & structs shared between UI and main ============
+
+extern int petPosX;
+extern int petPosY;
+
+enum Screen {
+  SCREEN_BOOT,
+  SCREEN_HATCH,
+  SCREEN_HOME,
+  SCREEN_MENU,
+  SCREEN_PET_STATUS,
+  SCREEN_ENVIRONMENT,
+  SCREEN_SYSINFO,
+  SCREEN_CONTROLS,
+  SCREEN_SETTINGS,
+  SCREEN_DIAGNOSTICS,
+  SCREEN_GAMEOVER
+};
+
+// ============ Logic -> render snapshot ============
+//
+// The logic task owns the game state below. After every step it publishes a
+// copy of everything the UI shows through a seqlock; the render task draws
+// from that copy only, so it never sees a half-applied update.
+
+struct UiSnapshot {
+  Screen    screen;
+  Activity  activity;
+  RestPhase restPhase;
+  Pet       pet;
+  WifiStats wifi;
+  Mood      mood;
+  Stage     stage;
+
+  bool      hungerEffectActive;
+  int       hungerEffectFrame;
+  bool      hatchTriggered;
+  bool      wifiScanInProgress;
+  int       restFrameIndex;
+
+  uint8_t   traitCuriosity;
+  uint8_t   traitActivity;
+  uint8_t   traitStress;
+
+  bool      soundEnabled;
+  bool      neoPixelsEnabled;
+  uint8_t   tftBrightnessIndex;
+  uint8_t   ledBrightnessIndex;
+  bool      autoSleep;
+  uint16_t  autoSaveMs;
+  uint16_t  timeScale;          // pet clock speed (pet_clock.h)
+
+  int       mainMenuIndex;
+  int       controlsIndex;
+  int       settingsMenuIndex;
+
+  PetEvalStats evals;           // Diagnostics only, zero elsewhere
+};
+
+void     publishSnapshot();                         // Logic side, after each step
+uint32_t readSnapshot(UiSnapshot& out);             // Render side, returns read attempts
+
+// Render -> logic: the hatch animation has played out
+void uiHatchFinished();
+
+// ============ Extern objects from main (TFT & sprites) ============
+
+extern TFT_eSPI tft;
+extern TFT_eSprite fb;
+extern TFT_eSprite petSprite;
+extern TFT_eSprite effectSprite;
+
+// ============ Shared game state (defined in TamaFi.ino) ============
+
+extern Screen    currentScreen;
+extern bool      hasHatchedOnce;
+
+extern bool      wifiScanInProgress;
+
+extern bool      soundEnabled;
+extern bool      neoPixelsEnabled;
+extern uint8_t   tftBrightnessIndex;
+extern uint8_t   ledBrightnessIndex;
+extern bool      autoSleep;
+extern uint16_t  autoSaveMs;
+
+// menus (main file owns, UI reads)
+extern int       mainMenuIndex;
+extern int       controlsIndex;
+extern int       settingsMenuIndex;
+
+// Hatch trigger: main sets true on OK, UI plays the hatch and reports back
+extern bool      hatchTriggered;
+
+// ============ UI API ============
+
+void uiInit();                                      // Call in setup()
+void uiDrawScreen();                                // Call from the render task; draws the latest snapshot
+uint32_t uiIdleMs();                                // Until the next animation frame is due (NO_DEADLINE: none)
+Screen uiShownScreen();                             // Screen the panel shows or is transitioning to
@@ -0,0 +1,27 @@
+#include "wall_clock.h"
+#include <sys/time.h>
+
+static WallMs systemMs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (WallMs)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+#ifdef ESP_PLATFORM
+static WallMs source() {
+    return systemMs();
+}
+#else
+static WallSource source = systemMs;
+
+void wallSetSource(WallSource src) {
+    source = src ? src : systemMs;
+}
+#endif
+
+bool wallNow(WallMs& out) {
+    WallMs ms = source();
+    if (ms < WALL_VALID_AFTER_MS) return false;
+    out = ms;
+    return true;
+}
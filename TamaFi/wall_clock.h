@@ -0,0 +1,24 @@
+#pragma once
+#include <Arduino.h>
+
+// ============ Wall clock ============
+//
+// Calendar time, for the one thing monotonic.h cannot measure: how long
+// the device was off. It is only known once something has set it (SNTP,
+// an RTC, or a software restart that kept the ESP32's RTC counter), and
+// it can jump when it is set, so nothing is scheduled by it.
+//
+// On the host the source is injectable, like monotonic.h, so a virtual
+// power-off can be as long as a test wants.
+
+typedef int64_t WallMs;     // milliseconds since 1970-01-01 UTC
+
+#define WALL_VALID_AFTER_MS   1704067200000LL     // 2024-01-01: earlier means never set
+
+bool wallNow(WallMs& out);                        // false while the clock is unset
+
+#ifndef ESP_PLATFORM
+typedef WallMs (*WallSource)();
+
+void wallSetSource(WallSource src);               // nullptr: the host's system clock
+#endif
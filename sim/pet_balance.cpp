@@ -0,0 +1,285 @@
+// Balance of the pet rules over many lives: every cell of a grid of
+// neighbourhoods (how many networks a scan finds) and trait values runs
+// many independent lifetimes of the firmware's own PetSim (pet_world.h),
+// and the report gives per cell how long pets survive, how their time
+// splits between moods and which stage they reach.
+//
+// Lives are cut into small jobs dealt round-robin to one deque per
+// thread. A thread takes its own newest job first and, once its deque is
+// empty, steals the oldest job of another, so a cell whose pets die in
+// minutes and one whose pets live for days keep every core busy to the
+// end. Each life is seeded from its cell and index alone, so the report
+// is the same for any number of threads.
+//
+//   ./pet_balance [--lives N] [--days N] [--threads N] [--seed S]
+//                 [--nets a,b,..] [--levels a,b,..] [--params FILE]
+//
+//   --lives N    lives per cell (default: 25)
+//   --days N     a life still going after this long counts as survived (default: 1)
+//   --threads N  worker threads (default: every core)
+//   --seed S     base seed (default: 1)
+//   --nets L     average networks per scan, one profile each (default: 0,1,3,12,40)
+//   --levels L   values tried for each of curiosity, activity and stress (default: 20,90)
+//   --params F   balance table over the defaults (pet_params.h)
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pet_world.h"
+
+static const uint32_t JOB_LIVES = 8;    // lives per job: small enough to balance, big enough to not lock often
+
+#define MOOD_COUNT   (MOOD_CALM + 1)
+#define STAGE_COUNT  (STAGE_ELDER + 1)
+
+static const char* const MOOD_NAMES[MOOD_COUNT] = {
+    "hungry", "happy", "curious", "bored", "sick", "excited", "calm"
+};
+
+static const char* const STAGE_NAMES[STAGE_COUNT] = { "baby", "teen", "adult", "elder" };
+
+struct Cell {
+    int     nets;
+    uint8_t curiosity, activity, stress;
+};
+
+// What a cell's lives add up to; survival in whole minutes, the last bin
+// holding the pets still alive at the end
+struct Tally {
+    std::vector<uint32_t> survival;
+    uint64_t lives = 0;
+    uint64_t died  = 0;
+    double   moodMs[MOOD_COUNT]   = {};
+    uint64_t stage[STAGE_COUNT]   = {};
+    double   simMs = 0;
+
+    void add(const Tally& o) {
+        for (size_t i = 0; i < survival.size(); i++) survival[i] += o.survival[i];
+        lives += o.lives;
+        died  += o.died;
+        for (int m = 0; m < MOOD_COUNT; m++)  moodMs[m] += o.moodMs[m];
+        for (int s = 0; s < STAGE_COUNT; s++) stage[s]  += o.stage[s];
+        simMs += o.simMs;
+    }
+};
+
+struct Job {
+    uint32_t cell;
+    uint32_t first, count;     // life indices within the cell
+};
+
+struct Worker {
+    std::mutex         lock;
+    std::deque<Job>    jobs;
+    std::vector<Tally> tallies;     // one per cell
+    uint64_t           stolen = 0;
+};
+
+static std::vector<Cell>    cells;
+static std::vector<Worker*> workers;
+static TimeMs               lifeEnd;
+static uint32_t             baseSeed = 1;
+static PetParams            params;
+
+static uint32_t lifeSeed(uint32_t cell, uint32_t life) {
+    uint32_t h = baseSeed * 0x9E3779B9u ^ cell * 0x85EBCA6Bu ^ life * 0xC2B2AE35u;
+    h ^= h >> 16;  h *= 0x7FEB352Du;
+    h ^= h >> 15;  h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h ? h : 1;
+}
+
+static void live(const Cell& c, uint32_t seed, Tally& t) {
+    PetSim pet;
+    World  world;
+    world.params  = params;
+    world.avgNets = c.nets;
+    world.adopt(pet, seed);
+    pet.state.traitCuriosity = c.curiosity;
+    pet.state.traitActivity  = c.activity;
+    pet.state.traitStress    = c.stress;
+
+    TimeMs now = 0;
+    while (now < lifeEnd && !pet.state.dead) {
+        Mood   mood = pet.state.mood;
+        TimeMs was  = now;
+        world.step(pet, now, lifeEnd);
+        t.moodMs[mood] += (double)(now - was);
+    }
+
+    size_t last = t.survival.size() - 1;
+    t.survival[pet.state.dead ? std::min<size_t>(world.diedAt / 60000, last - 1) : last]++;
+    t.lives++;
+    t.died  += pet.state.dead;
+    t.stage[pet.state.stage]++;
+    t.simMs += (double)now;
+}
+
+static bool takeOwn(Worker& w, Job& job) {
+    std::lock_guard<std::mutex> g(w.lock);
+    if (w.jobs.empty()) return false;
+    job = w.jobs.back();
+    w.jobs.pop_back();
+    return true;
+}
+
+static bool steal(size_t self, Job& job) {
+    for (size_t i = 1; i < workers.size(); i++) {
+        Worker& v = *workers[(self + i) % workers.size()];
+        std::lock_guard<std::mutex> g(v.lock);
+        if (v.jobs.empty()) continue;
+        job = v.jobs.front();
+        v.jobs.pop_front();
+        return true;
+    }
+    return false;
+}
+
+// Nothing is queued once work starts, so a thread that finds every deque
+// empty is done
+static void run(size_t self) {
+    Worker& w = *workers[self];
+    Job job;
+    for (;;) {
+        if (!takeOwn(w, job)) {
+            if (!steal(self, job)) return;
+            w.stolen++;
+        }
+        for (uint32_t i = 0; i < job.count; i++)
+            live(cells[job.cell], lifeSeed(job.cell, job.first + i), w.tallies[job.cell]);
+    }
+}
+
+static std::vector<int> parseList(const char* s) {
+    std::vector<int> v;
+    for (const char* p = s; *p; ) {
+        char* end;
+        long n = strtol(p, &end, 10);
+        if (end == p || n < 0) return {};
+        v.push_back((int)n);
+        if (*end && *end != ',') return {};
+        p = *end ? end + 1 : end;
+    }
+    return v;
+}
+
+static std::string duration(uint32_t minutes) {
+    char buf[16];
+    if (minutes < 60)        snprintf(buf, sizeof(buf), "%um", minutes);
+    else if (minutes < 1440) snprintf(buf, sizeof(buf), "%.1fh", minutes / 60.0);
+    else                     snprintf(buf, sizeof(buf), "%.1fd", minutes / 1440.0);
+    return buf;
+}
+
+// Minutes by which a fraction q of the cell's pets had died
+static std::string percentile(const Tally& t, double q) {
+    uint64_t want = (uint64_t)(q * t.lives + 0.5), seen = 0;
+    size_t   last = t.survival.size() - 1;
+    for (size_t m = 0; m < last; m++) {
+        seen += t.survival[m];
+        if (seen >= want && want) return duration((uint32_t)m + 1);
+    }
+    return ">" + duration((uint32_t)last);
+}
+
+static void usage() {
+    fprintf(stderr, "usage: pet_balance [--lives N] [--days N] [--threads N] [--seed S]\n"
+                    "                   [--nets a,b,..] [--levels a,b,..] [--params FILE]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    int              lives   = 25;
+    int              days    = 1;
+    int              threads = (int)std::thread::hardware_concurrency();
+    std::vector<int> nets    = { 0, 1, 3, 12, 40 };
+    std::vector<int> levels  = { 20, 90 };
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if      (a == "--lives" && i + 1 < argc)    lives    = atoi(argv[++i]);
+        else if (a == "--days" && i + 1 < argc)     days     = atoi(argv[++i]);
+        else if (a == "--threads" && i + 1 < argc)  threads  = atoi(argv[++i]);
+        else if (a == "--seed" && i + 1 < argc)     baseSeed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (a == "--nets" && i + 1 < argc)     nets     = parseList(argv[++i]);
+        else if (a == "--levels" && i + 1 < argc)   levels   = parseList(argv[++i]);
+        else if (a == "--params" && i + 1 < argc) { if (!readParams(argv[++i], params)) return 1; }
+        else usage();
+    }
+    if (threads <= 0) threads = 1;
+    if (lives <= 0 || days <= 0 || nets.empty() || levels.empty()) usage();
+    for (int l : levels) if (l > 100) usage();
+
+    lifeEnd = (TimeMs)days * 24 * 3600 * 1000;
+    size_t bins = (size_t)days * 1440 + 1;
+
+    for (int n : nets)
+        for (int c : levels)
+            for (int a : levels)
+                for (int s : levels)
+                    cells.push_back({ n, (uint8_t)c, (uint8_t)a, (uint8_t)s });
+
+    Tally empty;
+    empty.survival.assign(bins, 0);
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(new Worker);
+        workers.back()->tallies.assign(cells.size(), empty);
+    }
+
+    size_t next = 0;
+    for (uint32_t c = 0; c < cells.size(); c++)
+        for (uint32_t first = 0; first < (uint32_t)lives; first += JOB_LIVES) {
+            uint32_t count = std::min<uint32_t>(JOB_LIVES, lives - first);
+            workers[next++ % workers.size()]->jobs.push_back({ c, first, count });
+        }
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) pool.emplace_back(run, (size_t)i);
+    run(0);
+    for (auto& t : pool) t.join();
+    double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::vector<Tally> total(cells.size(), empty);
+    uint64_t stolen = 0;
+    for (Worker* w : workers) {
+        for (size_t c = 0; c < cells.size(); c++) total[c].add(w->tallies[c]);
+        stolen += w->stolen;
+    }
+
+    printf("%4s %3s %3s %3s %6s %6s %7s %7s %7s  ", "nets", "cur", "act", "str",
+           "lives", "died", "p10", "p50", "p90");
+    for (int m = 0; m < MOOD_COUNT; m++)  printf("%8s", MOOD_NAMES[m]);
+    printf(" ");
+    for (int s = 0; s < STAGE_COUNT; s++) printf("%7s", STAGE_NAMES[s]);
+    printf("\n");
+
+    Tally all = empty;
+    for (size_t c = 0; c < cells.size(); c++) {
+        const Tally& t = total[c];
+        all.add(t);
+        printf("%4d %3u %3u %3u %6llu %5.1f%% %7s %7s %7s  ", cells[c].nets,
+               cells[c].curiosity, cells[c].activity, cells[c].stress,
+               (unsigned long long)t.lives, 100.0 * t.died / t.lives,
+               percentile(t, 0.1).c_str(), percentile(t, 0.5).c_str(), percentile(t, 0.9).c_str());
+        for (int m = 0; m < MOOD_COUNT; m++)  printf("%7.1f%%", t.simMs ? 100.0 * t.moodMs[m] / t.simMs : 0.0);
+        printf(" ");
+        for (int s = 0; s < STAGE_COUNT; s++) printf("%6.1f%%", 100.0 * t.stage[s] / t.lives);
+        printf("\n");
+    }
+
+    printf("\np10/p50/p90: by when that share of the cell's pets had died; moods: share of time alive\n");
+    printf("%llu lives, %.1f simulated days in %.2f s on %d threads: %.0f lives/s, %.0f pet-days/s, %llu jobs stolen\n",
+           (unsigned long long)all.lives, all.simMs / 86400000.0, wallS, threads,
+           all.lives / wallS, all.simMs / 86400000.0 / wallS, (unsigned long long)stolen);
+
+    for (Worker* w : workers) delete w;
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Times the pet's utility scoring (pet_utility.h) with a catalogue the
+// size behaviour could grow to: the four activities PetSim builds, then
+// seeded made-up actions of two to six terms over random inputs and
+// curves, some gated, up to the engine's limit. Each decision scores the
+// whole catalogue on fresh random inputs, with and without the trace.
+//
+//   ./pet_decide [--actions N] [--decisions N] [--seed S]
+//
+//   --actions N    catalogue size, 4 .. 32 (default: 32)
+//   --decisions N  decisions timed, in thousands (default: 1000)
+//   --seed S       seed for the made-up actions and the inputs (default: 1)
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "pet_sim.h"
+
+static void addMadeUp(UtilityEngine& u, Pcg32& rng, int count) {
+    static const UtilCurve SHAPES[] = {
+        { UTIL_LINEAR,   1,   1,   0 },
+        { UTIL_LINEAR,  -1,   1, 100 },
+        { UTIL_STEP,    30, -20,   0 },
+        { UTIL_LOGISTIC, 50,  8,  60 },
+        { UTIL_LOGISTIC, 20, -5,  40 },
+    };
+    int first = -1;
+    for (const UtilCurve& c : SHAPES) {
+        int i = u.addCurve(c);
+        if (first < 0) first = i;
+    }
+    int gate = u.addGate({ UTIL_STEP, 3, UTIL_ONE / 4, UTIL_ONE });
+
+    for (int n = 0; n < count; n++) {
+        UtilAction a = { "made-up", ACT_NONE };
+        a.terms = (uint8_t)rng.range(2, UTIL_MAX_TERMS + 1);
+        for (int k = 0; k < a.terms; k++)
+            a.term[k] = { (uint8_t)rng.range(0, IN_COUNT),
+                          (uint8_t)(first + rng.range(0, sizeof(SHAPES) / sizeof(SHAPES[0]))),
+                          rng.range(UTIL_ONE / 4, 2 * UTIL_ONE) };
+        if (rng.range(0, 3) == 0) {
+            a.gateInput = (uint8_t)rng.range(0, IN_COUNT);
+            a.gateCurve = (uint8_t)gate;
+        }
+        for (int m = 0; m < UTIL_MAX_CONTEXTS; m++) a.context[m] = (int16_t)rng.range(-10, 11);
+        u.addAction(a);
+    }
+}
+
+// Nanoseconds per decision
+static double timeDecisions(const UtilityEngine& u, Pcg32 rng, uint32_t decisions, bool traced, uint64_t& tally) {
+    UtilTrace why;
+    uint8_t   in[UTIL_MAX_INPUTS] = {};
+    uint64_t  sum = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t d = 0; d < decisions; d++) {
+        uint32_t r = rng.next();
+        for (int i = 0; i < IN_COUNT; i += 4, r = rng.next())
+            for (int b = 0; b < 4 && i + b < IN_COUNT; b++) in[i + b] = (uint8_t)(r >> (8 * b)) % 101;
+        sum += u.choose(in, d % (MOOD_CALM + 1), traced ? &why : nullptr);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    tally = sum;
+    return ns / decisions;
+}
+
+static void usage() {
+    fprintf(stderr, "usage: pet_decide [--actions N] [--decisions N] [--seed S]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    int      actions   = UTIL_MAX_ACTIONS;
+    double   thousands = 1000;
+    uint32_t seed      = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if      (a == "--actions" && i + 1 < argc)   actions   = atoi(argv[++i]);
+        else if (a == "--decisions" && i + 1 < argc) thousands = atof(argv[++i]);
+        else if (a == "--seed" && i + 1 < argc)      seed      = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else usage();
+    }
+    if (actions < 4 || actions > UTIL_MAX_ACTIONS || thousands <= 0) usage();
+    const uint32_t decisions = (uint32_t)(thousands * 1000);
+
+    PetSim pet;
+    pet.begin(0, seed);
+    UtilityEngine& u = pet.utility();
+
+    Pcg32 rng;
+    rng.begin(seed, PET_STREAMS);
+    addMadeUp(u, rng, actions - u.actions());
+
+    uint64_t picked[2];
+    double   ns[2] = {
+        timeDecisions(u, rng, decisions, false, picked[0]),
+        timeDecisions(u, rng, decisions, true,  picked[1]),
+    };
+
+    printf("%d actions, %u decisions, seed %u, %zu bytes of tables and catalogue\n\n",
+           u.actions(), decisions, seed, sizeof(UtilityEngine));
+    printf("%-10s %12s %12s %14s\n", "trace", "ns/decision", "ns/action", "decisions/s");
+    for (int t = 0; t < 2; t++)
+        printf("%-10s %12.1f %12.2f %14.0f\n", t ? "on" : "off", ns[t], ns[t] / u.actions(), 1e9 / ns[t]);
+
+    if (picked[0] != picked[1]) {
+        printf("\nthe trace changed a decision\n");
+        return 1;
+    }
+    return 0;
+}
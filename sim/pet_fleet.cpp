@@ -0,0 +1,399 @@
+// Thousands of pets stepped together, for fleet-scale what-if studies:
+// the rules of PetSim (decay, scans, rest, mood, evolution, death and the
+// autonomous decision) applied to a whole population at a fixed
+// FLEET_TICK_MS step, each pet in its own neighbourhood.
+//
+// One tick is one pass over every pet with no branches in the rules:
+// every condition is a mask and every clamp a min/max, so with the pets
+// held as parallel arrays the compiler turns the pass into SIMD code
+// (AVX2 on x86-64, see the Makefile).
+// Pets are kept in blocks of FLEET_LANES, each field an array in the
+// block, so the arrays of one block can never overlap and the loop over a
+// block vectorises without run-time alias checks.
+//
+// The same rules, run over an array of one struct per pet, give the
+// scalar baseline; both layouts are stepped from the same start and must
+// end bit-identical. This is a statistical model, not PetSim: time moves
+// in whole ticks and every pet draws its random numbers each tick, so a
+// pet here does not replay a pet_life run.
+//
+//   ./pet_fleet [--pets N] [--minutes M] [--seed S] [--nets a,b,..]
+//
+//   --pets N     population (default: 10000)
+//   --minutes M  simulated time (default: 10)
+//   --seed S     seed for traits and neighbourhoods (default: 1)
+//   --nets L     average networks per scan; pets are spread over them (default: 0,1,3,12,40)
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "pet_world.h"      // SCAN_MS
+#include "ui_anim.h"        // rest pacing
+
+#define FLEET_TICK_MS   100     // every firmware timing is a whole number of these
+#define FLEET_LANES     64      // pets per block
+
+#define REST_IN_MS      (5 * REST_ENTER_DELAY)     // egg closing: five frames
+#define REST_OUT_MS     (5 * REST_WAKE_DELAY)
+
+#define MOOD_COUNT      (MOOD_CALM + 1)
+#define STAGE_COUNT     (STAGE_ELDER + 1)
+
+static const char* const MOOD_NAMES[MOOD_COUNT] = {
+    "hungry", "happy", "curious", "bored", "sick", "excited", "calm"
+};
+
+// Every field is 32 bits wide, so one vector register holds the same
+// number of lanes whatever field it carries
+#define PET_FIELDS(X)                                                       \
+    X(int32_t,  hunger)    X(int32_t, happiness) X(int32_t, health)         \
+    X(int32_t,  ageMin)    X(int32_t, stage)     X(int32_t, mood)           \
+    X(int32_t,  dead)      X(int32_t, curiosity) X(int32_t, stress)         \
+    X(int32_t,  activity)  X(int32_t, actLeft)   /* ms left in the scan or rest */ \
+    X(int32_t,  restAt)    /* actLeft at which rest pays out */             \
+    X(int32_t,  restPaid)                                                   \
+    X(int32_t,  tHunger)   X(int32_t, tHappy)    X(int32_t, tHealth)        \
+    X(int32_t,  tAge)      X(int32_t, tDecision)                            \
+    X(int32_t,  nets)      X(int32_t, strong)    X(int32_t, hidden)         \
+    X(int32_t,  open)      X(int32_t, rssi)                                 \
+    X(int32_t,  scanned)   X(int32_t, sinceScan) X(int32_t, avgNets)        \
+    X(uint32_t, rng)
+
+// Array of structs: one pet per element
+struct PetRow {
+#define X(type, name) type name;
+    PET_FIELDS(X)
+#undef X
+};
+
+// Structure of arrays: FLEET_LANES pets, one array per field
+struct PetBlock {
+#define X(type, name) type name[FLEET_LANES];
+    PET_FIELDS(X)
+#undef X
+};
+
+// One lane of a block, shaped like a PetRow so the same rules serve both
+struct PetLane {
+#define X(type, name) type& name;
+    PET_FIELDS(X)
+#undef X
+};
+
+// ---- branch-free helpers ----
+// A condition is a mask, all ones or all zeros, built from subtraction and
+// shifts alone. Every operand here is far from overflow, so the sign of a
+// difference is the comparison. Comparisons and selects in C++ would do
+// the same, but the compiler then mixes mask widths and gives up on
+// vectorising a loop this long.
+
+typedef int32_t Mask;
+
+static inline Mask lt(int32_t a, int32_t b)  { return (a - b) >> 31; }
+static inline Mask gt(int32_t a, int32_t b)  { return (b - a) >> 31; }
+static inline Mask le(int32_t a, int32_t b)  { return ~gt(a, b); }
+static inline Mask ge(int32_t a, int32_t b)  { return ~lt(a, b); }
+static inline Mask isZero(int32_t a)         { return ~((a | -a) >> 31); }
+static inline Mask eq(int32_t a, int32_t b)  { return isZero(a - b); }
+static inline Mask flag(int32_t f)           { return -f; }          // 0 / 1 field to a mask
+
+static inline int32_t sel(Mask m, int32_t a, int32_t b) { return (a & m) | (b & ~m); }
+static inline int32_t when(Mask m, int32_t a)           { return a & m; }
+
+static inline int32_t clampStat(int32_t v) { return std::min(std::max(v, 0), 100); }
+static inline int32_t atLeast0(int32_t v)  { return std::max(v, 0); }
+
+static inline uint32_t xorshift(uint32_t& s) {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+// In [lo, hi) from 16 random bits; a multiply, not a division
+static inline int32_t range16(uint32_t bits, int32_t lo, int32_t hi) {
+    return lo + (int32_t)(((bits & 0xFFFF) * (uint32_t)(hi - lo)) >> 16);
+}
+
+// ---- the rules, one pet ----
+// Order as PetSim::tick(): stats and outcomes first, then mood,
+// evolution, death and the decision.
+
+template <class P>
+static inline void tickPet(P& p) {
+    const int32_t dt    = FLEET_TICK_MS;
+    const Mask    alive = ~flag(p.dead);
+
+    uint32_t r0 = xorshift(p.rng), r1 = xorshift(p.rng);
+    uint32_t r2 = xorshift(p.rng), r3 = xorshift(p.rng);
+
+    // Decay and ageing: a stat steps when its period runs out
+    p.sinceScan += dt;
+    p.tHunger -= dt;  p.tHappy -= dt;  p.tHealth -= dt;  p.tAge -= dt;
+    Mask stepHunger = le(p.tHunger, 0), stepHappy = le(p.tHappy, 0);
+    Mask stepHealth = le(p.tHealth, 0), stepAge   = le(p.tAge, 0);
+    p.tHunger += when(stepHunger, HUNGER_DECAY_MS);
+    p.tHappy  += when(stepHappy,  HAPPINESS_DECAY_MS);
+    p.tHealth += when(stepHealth, HEALTH_DECAY_MS);
+    p.tAge    += when(stepAge,    AGE_TICK_MS);
+
+    Mask bored    = isZero(p.nets) & gt(p.sinceScan, WIFI_BORED_MS);
+    Mask starving = lt(p.hunger, 20) | lt(p.happiness, 20);
+    p.hunger    = atLeast0(p.hunger    - when(stepHunger, 2));
+    p.happiness = atLeast0(p.happiness - when(stepHappy,  sel(bored, 3, 1)));
+    p.health    = atLeast0(p.health    - when(stepHealth, sel(starving, 2, 1)));
+    p.ageMin   += when(alive & stepAge, 1);
+
+    // A hunt or discovery ends when its scan does
+    p.actLeft    -= when(~eq(p.activity, ACT_NONE), dt);
+    Mask hunting  = eq(p.activity, ACT_HUNT);
+    Mask finding  = eq(p.activity, ACT_DISCOVER);
+    Mask scanDone = (hunting | finding) & le(p.actLeft, 0);
+
+    int32_t n      = range16(r0, 0, p.avgNets * 2 + 1);
+    Mask    any    = gt(n, 0);
+    int32_t strong = when(any, range16(r0 >> 16, 0, n / 3 + 1));
+    int32_t hidden = when(any, range16(r1, 0, n / 5 + 1));
+    int32_t open   = when(any, range16(r1 >> 16, 0, n / 4 + 1));
+    int32_t rssi   = sel(any, range16(r2, -88, -55), -100);
+
+    p.nets      = sel(scanDone, n, p.nets);
+    p.strong    = sel(scanDone, strong, p.strong);
+    p.hidden    = sel(scanDone, hidden, p.hidden);
+    p.open      = sel(scanDone, open, p.open);
+    p.rssi      = sel(scanDone, rssi, p.rssi);
+    p.sinceScan = sel(scanDone, 0, p.sinceScan);
+    p.scanned   = sel(scanDone, 1, p.scanned);
+
+    // As resolveHunt() and resolveDiscover(), on the new results
+    int32_t huntHunger = sel(any, std::min(n * 2 + strong * 3, 35), -15);
+    int32_t huntHappy  = sel(any, std::min((hidden * 2 + open) * 3 + (rssi + 100) / 3, 30), -10);
+    int32_t huntHealth = sel(any, when(gt(rssi, -75), 5) + when(gt(rssi, -65), 5) + when(gt(strong, 5), 3), -5);
+    int32_t discHappy  = sel(any, std::min((hidden * 4 + open * 3 + n) / 2, 35), -5);
+    int32_t discHunger = sel(any, -5, -3);
+
+    Mask hunted     = scanDone & hunting;
+    Mask discovered = scanDone & finding;
+    p.hunger    = clampStat(p.hunger + when(hunted, huntHunger) + when(discovered, discHunger));
+    p.happiness = clampStat(p.happiness + when(hunted, huntHappy) + when(discovered, discHappy));
+    p.health    = clampStat(p.health + when(hunted, huntHealth));
+    p.activity  = sel(scanDone, ACT_NONE, p.activity);
+
+    // Rest pays out halfway through deep sleep and ends after waking
+    Mask resting = eq(p.activity, ACT_REST);
+    Mask payOut  = resting & ~flag(p.restPaid) & le(p.actLeft, p.restAt);
+    p.hunger     = clampStat(p.hunger    - when(payOut, 3));
+    p.happiness  = clampStat(p.happiness + when(payOut, 10));
+    p.health     = clampStat(p.health    + when(payOut, 15));
+    p.restPaid   = sel(payOut, 1, p.restPaid);
+    p.activity   = sel(resting & le(p.actLeft, 0), ACT_NONE, p.activity);
+
+    // Mood, as PetSim::updateMood(): the first rule that holds wins, so
+    // they are applied last to first
+    Mask quiet = isZero(p.nets);
+    Mask sick  = lt(p.health, 25) | (quiet & flag(p.scanned) & gt(p.sinceScan, WIFI_SICK_MS));
+    bored      = quiet & gt(p.sinceScan, WIFI_BORED_MS);
+
+    int32_t mood = MOOD_CALM;
+    mood = sel(gt(p.hidden, 0) | gt(p.open, 0),          MOOD_CURIOUS, mood);
+    mood = sel(bored,                                    MOOD_BORED,   mood);
+    mood = sel(gt(p.happiness, 60) & gt(p.nets, 0),      MOOD_HAPPY,   mood);
+    mood = sel(gt(p.happiness, 80) & gt(p.nets, 8),      MOOD_EXCITED, mood);
+    mood = sel(lt(p.hunger, 25),                         MOOD_HUNGRY,  mood);
+    mood = sel(sick,                                     MOOD_SICK,    mood);
+    p.mood = mood;
+
+    // Evolution reads the minutes within the hour, as the firmware does
+    int32_t minute = p.ageMin % 60;
+    int32_t avg    = (p.hunger + p.happiness + p.health) / 3;
+    int32_t stage  = STAGE_BABY;
+    stage = sel(ge(minute, 20)  & gt(avg, 35), STAGE_TEEN,  stage);
+    stage = sel(ge(minute, 60)  & gt(avg, 45), STAGE_ADULT, stage);
+    stage = sel(ge(minute, 180) & gt(avg, 40), STAGE_ELDER, stage);
+    p.stage = sel(alive, std::max(stage, (int32_t)p.stage), p.stage);
+
+    Mask dies  = alive & le(p.hunger, 0) & le(p.happiness, 0) & le(p.health, 0);
+    p.dead     = sel(dies, 1, p.dead);
+    p.activity = sel(dies, ACT_NONE, p.activity);
+
+    // The decision, as PetSim::decide(); an overdue one waits for idle
+    p.tDecision -= when(alive, dt);
+    Mask decide = ~flag(p.dead) & eq(p.activity, ACT_NONE) & le(p.tDecision, 0);
+
+    Mask    noNets = isZero(p.nets);
+    int32_t hunt   = (100 - p.hunger) + p.curiosity / 2;
+    int32_t disc   = p.curiosity + p.hidden * 10 + p.open * 6 + p.nets * 2 + range16(r3, 0, 20);
+    int32_t rest   = (100 - p.health) + p.stress / 2 - when(lt(p.hunger, 20), 10);
+    hunt = sel(noNets, hunt / 2, hunt);
+    disc = sel(noNets, disc / 2, disc);
+
+    Mask hungry   = eq(p.mood, MOOD_HUNGRY);
+    Mask curious  = eq(p.mood, MOOD_CURIOUS);
+    Mask ill      = eq(p.mood, MOOD_SICK);
+    Mask restless = eq(p.mood, MOOD_EXCITED) | eq(p.mood, MOOD_BORED);
+    hunt += when(hungry, 20) + when(restless, 5);
+    disc += when(curious, 15) - when(ill, 10) + when(restless, 10);
+    rest += when(ill, 20) - when(hungry, 10);
+
+    hunt = atLeast0(hunt);
+    disc = atLeast0(disc);
+    rest = atLeast0(rest);
+
+    int32_t best = 10, chosen = ACT_NONE;
+    chosen = sel(gt(hunt, best), ACT_HUNT, chosen);      best = std::max(best, hunt);
+    chosen = sel(gt(disc, best), ACT_DISCOVER, chosen);  best = std::max(best, disc);
+    chosen = sel(gt(rest, best), ACT_REST, chosen);
+
+    int32_t restMs = range16(r3 >> 16, REST_MIN_DURATION, REST_MAX_DURATION);
+    int32_t lasts  = sel(eq(chosen, ACT_REST), REST_IN_MS + restMs + REST_OUT_MS,
+                         when(~eq(chosen, ACT_NONE), SCAN_MS));
+
+    p.tDecision = sel(decide, range16(r2 >> 16, DECISION_INTERVAL_MIN, DECISION_INTERVAL_MAX), p.tDecision);
+    p.activity  = sel(decide, chosen, p.activity);
+    p.actLeft   = sel(decide, lasts, p.actLeft);
+    p.restAt    = sel(decide, REST_OUT_MS + restMs - restMs / 2 - 1, p.restAt);
+    p.restPaid  = sel(decide, 0, p.restPaid);
+}
+
+// ---- the two layouts ----
+
+static void tickRows(PetRow* rows, size_t n) {
+    for (size_t i = 0; i < n; i++) tickPet(rows[i]);
+}
+
+static void tickBlock(PetBlock& b) {
+    for (int i = 0; i < FLEET_LANES; i++) {
+#define X(type, name) b.name[i],
+        PetLane lane = { PET_FIELDS(X) };
+#undef X
+        tickPet(lane);
+    }
+}
+
+static void tickBlocks(PetBlock* blocks, size_t n) {
+    for (size_t i = 0; i < n; i++) tickBlock(blocks[i]);
+}
+
+static PetRow newborn(uint32_t seed, int avgNets) {
+    PetRow p;
+    memset(&p, 0, sizeof(p));
+    p.hunger = p.happiness = p.health = 70;
+    p.mood      = MOOD_CALM;
+    p.rng       = seed ? seed : 1;
+    p.curiosity = range16(xorshift(p.rng), 20, 101);
+    p.stress    = range16(xorshift(p.rng), 20, 101);
+    p.avgNets   = avgNets;
+    p.rssi      = -100;
+    p.tHunger   = HUNGER_DECAY_MS;
+    p.tHappy    = HAPPINESS_DECAY_MS;
+    p.tHealth   = HEALTH_DECAY_MS;
+    p.tAge      = AGE_TICK_MS;
+    p.tDecision = DECISION_INTERVAL_FIRST;
+    return p;
+}
+
+#define X(type, name) b.name[lane] = p.name;
+static void storeLane(PetBlock& b, int lane, const PetRow& p) { PET_FIELDS(X) }
+#undef X
+
+#define X(type, name) p.name = b.name[lane];
+static PetRow loadLane(const PetBlock& b, int lane) { PetRow p; PET_FIELDS(X) return p; }
+#undef X
+
+static std::vector<int> parseList(const char* s) {
+    std::vector<int> v;
+    for (const char* p = s; *p; ) {
+        char* end;
+        long n = strtol(p, &end, 10);
+        if (end == p || n < 0) return {};
+        v.push_back((int)n);
+        if (*end && *end != ',') return {};
+        p = *end ? end + 1 : end;
+    }
+    return v;
+}
+
+static void usage() {
+    fprintf(stderr, "usage: pet_fleet [--pets N] [--minutes M] [--seed S] [--nets a,b,..]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    long             pets    = 10000;
+    double           minutes = 10;
+    uint32_t         seed    = 1;
+    std::vector<int> nets    = { 0, 1, 3, 12, 40 };
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if      (a == "--pets" && i + 1 < argc)     pets    = atol(argv[++i]);
+        else if (a == "--minutes" && i + 1 < argc)  minutes = atof(argv[++i]);
+        else if (a == "--seed" && i + 1 < argc)     seed    = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (a == "--nets" && i + 1 < argc)     nets    = parseList(argv[++i]);
+        else usage();
+    }
+    if (pets <= 0 || minutes <= 0 || nets.empty()) usage();
+
+    const long   ticks   = (long)(minutes * 60000 / FLEET_TICK_MS);
+    const size_t nBlocks = (pets + FLEET_LANES - 1) / FLEET_LANES;
+
+    // Lanes past the population are dead from the start and stay inert
+    std::vector<PetRow>   rows(pets);
+    std::vector<PetBlock> blocks(nBlocks);
+    for (size_t i = 0; i < nBlocks * FLEET_LANES; i++) {
+        PetRow p = newborn((uint32_t)(seed * 2654435761u + i * 0x9E3779B9u), nets[i % nets.size()]);
+        if ((long)i < pets) rows[i] = p;
+        else                p.dead = 1;
+        storeLane(blocks[i / FLEET_LANES], i % FLEET_LANES, p);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (long t = 0; t < ticks; t++) tickRows(rows.data(), rows.size());
+    double aosS = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    t0 = std::chrono::steady_clock::now();
+    for (long t = 0; t < ticks; t++) tickBlocks(blocks.data(), blocks.size());
+    double soaS = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    long mismatched = 0;
+    for (long i = 0; i < pets; i++) {
+        PetRow p = loadLane(blocks[i / FLEET_LANES], i % FLEET_LANES);
+        mismatched += memcmp(&p, &rows[i], sizeof(p)) != 0;
+    }
+
+    printf("%4s %7s %6s %7s %7s %7s %6s  ", "nets", "pets", "alive", "hunger", "happy", "health", "teen+");
+    for (int m = 0; m < MOOD_COUNT; m++) printf("%8s", MOOD_NAMES[m]);
+    printf("\n");
+
+    for (size_t k = 0; k < nets.size(); k++) {
+        long   count = 0, alive = 0, teen = 0, mood[MOOD_COUNT] = {};
+        double hunger = 0, happy = 0, health = 0;
+        for (long i = k; i < pets; i += nets.size()) {
+            const PetRow& p = rows[i];
+            count++;
+            alive  += !p.dead;
+            teen   += p.stage >= STAGE_TEEN;
+            hunger += p.hunger;  happy += p.happiness;  health += p.health;
+            if (!p.dead) mood[p.mood]++;
+        }
+        if (!count) continue;
+        printf("%4d %7ld %5.1f%% %7.1f %7.1f %7.1f %5.1f%%  ", nets[k], count, 100.0 * alive / count,
+               hunger / count, happy / count, health / count, 100.0 * teen / count);
+        for (int m = 0; m < MOOD_COUNT; m++) printf("%7.1f%%", alive ? 100.0 * mood[m] / alive : 0.0);
+        printf("\n");
+    }
+
+    double petTicks = (double)pets * ticks;
+    printf("\n%ld pets x %ld ticks of %d ms (%.1f simulated minutes)\n", pets, ticks, FLEET_TICK_MS,
+           ticks * FLEET_TICK_MS / 60000.0);
+    printf("%-26s %10.3f s %14.0f pet-ticks/s\n", "array of structs", aosS, petTicks / aosS);
+    printf("%-26s %10.3f s %14.0f pet-ticks/s  (x%.1f)\n", "structure of arrays", soaS, petTicks / soaS,
+           aosS / soaS);
+    printf("layouts %s\n", mismatched ? "DIFFER" : "agree on every pet");
+    return mismatched ? 1 : 0;
+}
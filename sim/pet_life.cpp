@@ -0,0 +1,259 @@
+// A pet's whole life on the host: the firmware's PetSim (pet_sim.h) built
+// on its own, without the Arduino stand-ins, advanced from one deadline
+// to the next instead of in real time. Hunts and discoveries get results
+// from a seeded model of the neighbourhood's networks, returned after a
+// realistic scan time.
+//
+// The pet starts on HOME, hatched and left alone; it feeds, explores and
+// rests by itself until it dies or the time is up. With --away it first
+// spends that long with the device switched off, caught up in one step
+// the way the firmware does on boot, and checks that happiness fell at
+// the rate for quiet air, as nothing was scanned, and that the quiet air
+// alone cannot make it sick before its first scan. --boot sets where the
+// pet clock stands when the device comes back: a software restart can
+// bring it back after less time off than that.
+//
+//   ./pet_life [--days N] [--seed S] [--nets N] [--away MIN] [--boot SEC] [--params FILE]
+//              [--why N] [--dense MS]
+//   ./pet_life --print-params
+//
+//   --days N        longest life simulated, in days (default: 28)
+//   --seed S        seed for both the pet and the neighbourhood (default: 1)
+//   --nets N        networks a scan finds on average (default: 12)
+//   --away M        minutes switched off before the life starts
+//   --boot S        pet-clock seconds at boot, where the life starts (default: 0)
+//   --params FILE   balance table over the defaults (pet_params.h)
+//   --why N         explain the first N autonomous decisions: every
+//                   activity's score and what made it up
+//   --dense MS      live the same life again, advanced every MS of pet time
+//                   on top of its deadlines, and fail unless every mood
+//                   change, event and stat comes out the same: PetSim must
+//                   stop wherever the rules could decide something new
+//   --print-params  write the default table, to start one from
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pet_world.h"
+
+static const char* const EVENT_NAMES[EV_TYPE_COUNT] = {
+    "click", "fed", "discovered", "scan_started", "activity_ended", "feed_effect_ended",
+    "rest_started", "asleep", "rest_ended", "evolved", "died", "hatch_started", "reset"
+};
+
+static const char* const STAGE_NAMES[] = { "baby", "teen", "adult", "elder" };
+
+static const char* const MOOD_NAMES[] = {
+    "hungry", "happy", "curious", "bored", "sick", "excited", "calm"
+};
+
+static const char* const INPUT_NAMES[IN_COUNT] = {
+    "hunger", "happiness", "health", "curiosity", "activity", "stress",
+    "nets", "strong", "hidden", "open", "signal", "jitter"
+};
+
+struct WhyLog {
+    PetSim* pet;
+    int     left;
+};
+
+static void onDecision(void* ctx, const UtilTrace& why, TimeMs at) {
+    WhyLog& log = *(WhyLog*)ctx;
+    if (log.left <= 0) return;
+    log.left--;
+
+    const UtilityEngine& u = log.pet->utility();
+    uint32_t s = (uint32_t)(at / 1000);
+    printf("%3ud %02u:%02u:%02u  %s, chose %s\n", s / 86400, s / 3600 % 24, s / 60 % 60, s % 60,
+           MOOD_NAMES[why.context], u.action(why.chosen).name);
+
+    for (int i = 0; i < why.actions; i++) {
+        const UtilAction& a = u.action(i);
+        printf("  %-10s %4d =", a.name, why.score[i]);
+        if (a.base) printf(" %d", a.base);
+        for (int k = 0; k < a.terms; k++) {
+            const UtilTerm& t = a.term[k];
+            printf(" %+.1f %s(%u)", why.term[i][k] / (double)(UTIL_ONE << UTIL_CURVE_SHIFT),
+                   INPUT_NAMES[t.input], why.input[t.input]);
+        }
+        if (why.gate[i] != UTIL_ONE) printf(", x%.2f %s", why.gate[i] / (double)UTIL_ONE, INPUT_NAMES[a.gateInput]);
+        if (a.context[why.context]) printf(", %+d mood", a.context[why.context]);
+        printf("\n");
+    }
+}
+
+static void printParams(const PetParams& p) {
+    printf("version = %d\n", (int)p.version);
+#define PRINT_PARAM(name, def, least, most) printf("%s = %d\n", #name, (int)p.name);
+    PET_PARAMS(PRINT_PARAM)
+#undef PRINT_PARAM
+}
+
+// Each mood the pet changes to and when, as seen after every step
+typedef std::vector<std::pair<TimeMs, int>> MoodLog;
+
+static void logMood(MoodLog& log, const PetSim& pet, TimeMs now) {
+    if (log.empty() || log.back().second != pet.state.mood) log.push_back({ now, pet.state.mood });
+}
+
+static bool samePet(const Pet& a, const Pet& b) {
+    return a.hunger == b.hunger && a.happiness == b.happiness && a.health == b.health &&
+           a.ageMinutes == b.ageMinutes && a.ageHours == b.ageHours && a.ageDays == b.ageDays;
+}
+
+// The same life, also stopping at every multiple of `every`
+static void denseLife(PetSim& pet, World& world, TimeMs start, TimeMs end, TimeMs every, MoodLog& moods) {
+    TimeMs now = start;
+    moods = { { start, pet.state.mood } };
+    while (now < end && !pet.state.dead) {
+        world.step(pet, now, std::min(end, (now / every + 1) * every));
+        logMood(moods, pet, now);
+    }
+}
+
+static void usage() {
+    fprintf(stderr, "usage: pet_life [--days N] [--seed S] [--nets N] [--away MIN] [--boot SEC] [--params FILE]\n"
+                    "                [--why N] [--dense MS]\n"
+                    "       pet_life --print-params\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    int      days = 28;
+    uint32_t seed = 1;
+    double   away = 0;
+    double   boot = 0;
+    int      why  = 0;
+    TimeMs   dense = 0;
+    World    world;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if      (a == "--days" && i + 1 < argc)  days = atoi(argv[++i]);
+        else if (a == "--seed" && i + 1 < argc)  seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (a == "--nets" && i + 1 < argc)  world.avgNets = atoi(argv[++i]);
+        else if (a == "--away" && i + 1 < argc)  away = atof(argv[++i]);
+        else if (a == "--boot" && i + 1 < argc)  boot = atof(argv[++i]);
+        else if (a == "--params" && i + 1 < argc) { if (!readParams(argv[++i], world.params)) return 1; }
+        else if (a == "--print-params")          { printParams(world.params); return 0; }
+        else if (a == "--why" && i + 1 < argc)   why  = atoi(argv[++i]);
+        else if (a == "--dense" && i + 1 < argc) dense = atoll(argv[++i]);
+        else usage();
+    }
+    if (days <= 0 || world.avgNets < 0 || away < 0 || boot < 0 || why < 0 || dense < 0) usage();
+
+    PetSim pet, twin;
+    World  twinWorld = world;
+    const TimeMs start = (TimeMs)(boot * 1000);
+    world.adopt(pet, seed, start);
+    if (dense > 0) twinWorld.adopt(twin, seed, start);
+
+    WhyLog whyLog = { &pet, why };
+    if (why) pet.setDecisionTrace(onDecision, &whyLog);
+
+    if (away > 0) {
+        const int happiness = pet.state.pet.happiness;
+        const TimeMs offMs  = (TimeMs)(away * 60000);
+
+        auto a0 = std::chrono::steady_clock::now();
+        pet.catchUp(start, offMs);
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - a0).count();
+        if (dense > 0) twin.catchUp(start, offMs);
+
+        const Pet& p = pet.state.pet;
+        printf("%.0f min away, caught up in %.1f us: hunger %d, happiness %d, health %d, age %lud %luh %lum%s\n",
+               away, us, p.hunger, p.happiness, p.health, p.ageDays, p.ageHours, p.ageMinutes,
+               pet.state.dead ? ", dead" : "");
+
+        // Nothing scans while switched off: every happiness tick from
+        // wifiBoredMs after switching off comes at the quiet rate
+        const PetParams& pp  = pet.params();
+        int64_t ticks = offMs / pp.happinessDecayMs;
+        int64_t loud  = std::min<int64_t>(ticks, pp.wifiBoredMs / pp.happinessDecayMs);
+        int64_t want  = std::max<int64_t>(0, happiness - loud * pp.happinessDecay - (ticks - loud) * pp.happinessDecayQuiet);
+        printf("happiness %d -> %d while away, quiet rate after %d s: %s\n", happiness, p.happiness,
+               (int)(pp.wifiBoredMs / 1000), p.happiness == want ? "ok" : "WRONG");
+        if (p.happiness != want) return 1;
+
+        // Until a scan, quiet air can bore the pet but not sicken it: left
+        // where nothing scans, it is still not sick once wifiSickMs is up
+        PetSim idle = pet;
+        idle.setEventSink(nullptr, nullptr);
+        idle.setDecisionTrace(nullptr, nullptr);
+        idle.setAutonomous(false);
+        idle.advance(start + pp.wifiSickMs + 1);
+        bool airSick = idle.state.mood == MOOD_SICK && idle.state.pet.health >= pp.sickBelow;
+        printf("%d s on with no scan: %s\n\n", (int)(pp.wifiSickMs / 1000 + 1),
+               airSick ? "SICK FROM QUIET AIR" : "not sick from the air");
+        if (airSick) return 1;
+    }
+
+    const TimeMs end = start + (TimeMs)days * 24 * 3600 * 1000;
+    uint64_t     steps = 0;
+    TimeMs       now   = start;
+    MoodLog      moods = { { start, pet.state.mood } };
+
+    auto t0 = std::chrono::steady_clock::now();
+    while (now < end && !pet.state.dead) {
+        world.step(pet, now, end);
+        logMood(moods, pet, now);
+        steps++;
+    }
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    if (dense > 0) {
+        MoodLog twinMoods;
+        denseLife(twin, twinWorld, start, end, dense, twinMoods);
+        bool same = twinMoods == moods && twin.state.dead == pet.state.dead &&
+                    !memcmp(twinWorld.events, world.events, sizeof(world.events)) &&
+                    samePet(twin.state.pet, pet.state.pet);
+        printf("advanced every %lld ms as well: %s\n\n", (long long)dense,
+               same ? "the same life" : "A DIFFERENT LIFE");
+        if (!same) {
+            for (size_t i = 0; i < moods.size() || i < twinMoods.size(); i++) {
+                if (i < moods.size() && i < twinMoods.size() && moods[i] == twinMoods[i]) continue;
+                if (i < moods.size())
+                    printf("  first mood change apart: %s at %lld ms", MOOD_NAMES[moods[i].second], (long long)moods[i].first);
+                else
+                    printf("  first mood change apart: none");
+                if (i < twinMoods.size())
+                    printf(", %s at %lld ms advanced often\n", MOOD_NAMES[twinMoods[i].second], (long long)twinMoods[i].first);
+                else
+                    printf(", none advanced often\n");
+                break;
+            }
+            return 1;
+        }
+    }
+
+    const PetState& st = pet.state;
+    if (st.dead && world.diedAt < start)
+        printf("died %.2f days into the time switched off\n", (world.diedAt - start + away * 60000) / 86400000.0);
+    else if (st.dead)
+        printf("died after %.2f days\n", (world.diedAt - start) / 86400000.0);
+    else
+        printf("alive after %d days\n", days);
+    printf("stage %s, age %lud %luh %lum, hunger %d, happiness %d, health %d\n",
+           STAGE_NAMES[st.stage], st.pet.ageDays, st.pet.ageHours, st.pet.ageMinutes,
+           st.pet.hunger, st.pet.happiness, st.pet.health);
+
+    printf("\n%-20s %12s\n", "event", "count");
+    for (int e = 0; e < EV_TYPE_COUNT; e++)
+        if (world.events[e]) printf("%-20s %12llu\n", EVENT_NAMES[e], (unsigned long long)world.events[e]);
+
+    const PetEvalStats& ev = pet.evalStats();
+    printf("\n%-20s %12s %12s\n", "evaluations", "run", "saved");
+    printf("%-20s %12u %12u\n", "mood", ev.moodRuns, ev.moodSaved);
+    printf("%-20s %12u %12u\n", "evolution", ev.evolveRuns, ev.evolveSaved);
+
+    printf("\n%.2f simulated days in %llu steps, %.1f ms (%.0fx real time)\n",
+           (now - start) / 86400000.0, (unsigned long long)steps, wallMs,
+           wallMs > 0 ? (now - start) / wallMs : 0.0);
+    return 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+// The neighbourhood a host-run pet lives in, shared by pet_life and
+// pet_balance: a seeded model of the networks a scan finds, returned a
+// realistic scan time after the pet asks, and the loop that moves a
+// PetSim from one deadline to the next.
+
+#include <stdio.h>
+#include <string>
+
+#include "pet_sim.h"
+
+static const TimeMs SCAN_MS = 2500;     // an active scan of every channel
+
+// A balance table (pet_params.h) from a file, over the defaults; false,
+// having said why, if it cannot be used
+static inline bool readParams(const char* path, PetParams& p) {
+    FILE* f = fopen(path, "rb");
+    if (!f) { fprintf(stderr, "cannot read %s\n", path); return false; }
+    std::string text;
+    char buf[4096];
+    for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0; ) text.append(buf, n);
+    fclose(f);
+
+    if (const char* err = petParamsParse(p, text.c_str())) {
+        fprintf(stderr, "%s: %s\n", path, err);
+        return false;
+    }
+    return true;
+}
+
+struct World {
+    PetParams params;
+    Pcg32    rng;
+    int      avgNets    = 12;
+    TimeMs   scanDoneAt = PET_NEVER;
+    uint64_t events[EV_TYPE_COUNT] = {};
+    TimeMs   diedAt     = PET_NEVER;
+
+    int range(int lo, int hi) { return rng.range(lo, hi); }
+
+    WifiStats scan() {
+        WifiStats s;
+        s.netCount = range(0, avgNets * 2 + 1);
+        if (!s.netCount) return s;
+        s.strongCount = range(0, s.netCount / 3 + 1);
+        s.hiddenCount = range(0, s.netCount / 5 + 1);
+        s.openCount   = range(0, s.netCount / 4 + 1);
+        s.wpaCount    = s.netCount - s.openCount;
+        s.avgRSSI     = range(-88, -55);
+        return s;
+    }
+
+    static void onEvent(void* ctx, PetEventType type, uint8_t, TimeMs at) {
+        World& w = *(World*)ctx;
+        w.events[type]++;
+        if (type == EV_SCAN_STARTED) w.scanDoneAt = at + SCAN_MS;
+        if (type == EV_DIED)         w.diedAt = at;
+    }
+
+    // A hatched pet left alone on HOME from `start`, with this world
+    // answering its scans
+    void adopt(PetSim& pet, uint32_t seed, TimeMs start = 0) {
+        rng.begin(seed, PET_STREAMS);     // the pet's seed, a stream of its own
+        pet.setEventSink(onEvent, this);
+        pet.setParams(params);
+        pet.begin(start, seed);
+        pet.setTicking(true);
+        pet.setAutonomous(true);
+    }
+
+    // To the pet's next deadline or the world's, at most end
+    void step(PetSim& pet, TimeMs& now, TimeMs end) {
+        TimeMs next = pet.nextDue(now);
+        if (scanDoneAt < next) next = scanDoneAt;
+        if (next > end) next = end;
+        now = next > now ? next : now + 1;
+
+        if (scanDoneAt <= now) {
+            scanDoneAt = PET_NEVER;
+            pet.scanDone(now, scan());
+        }
+        pet.advance(now);
+    }
+};
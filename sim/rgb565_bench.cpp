@@ -0,0 +1,275 @@
+// Checks the RGB565 pixel kernels (rgb565.h) against a one-pixel-at-a-time
+// scalar reference and times both on full 240x240 frames.
+//
+// The reference unpacks each pixel into its three channels and applies
+// the formula the kernel comment states; every kernel must match it bit
+// for bit in both byte orders, at every alpha or brightness level, on
+// rows of every length from 1 to MAX_ROW pixels (odd lengths end in the
+// kernels' single-pixel tail) and, for the mask expander, at every mask
+// column offset.
+//
+//   ./rgb565_bench [--frames N] [--seed S]
+//
+//   --frames N  frames per kernel for the timings (default: 2000)
+//   --seed S    seed for the pixels, alphas and masks (default: 1)
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "pet_rng.h"
+#include "rgb565.h"
+
+#define FRAME_W   240
+#define FRAME_H   240
+#define FRAME_PX  (FRAME_W * FRAME_H)
+#define MAX_ROW   37
+
+// ---- scalar reference ----
+
+static uint16_t refLoad(uint16_t c, bool swapped)  { return swapped ? rgb565Swap1(c) : c; }
+
+struct Rgb { uint32_t r, g, b; };
+
+static Rgb split(uint16_t c) { return { (uint32_t)(c >> 11) & 0x1F, (uint32_t)(c >> 5) & 0x3F, (uint32_t)c & 0x1F }; }
+static uint16_t join(Rgb c)  { return (uint16_t)(c.r << 11 | c.g << 5 | c.b); }
+
+static uint32_t mixChannel(uint32_t s, uint32_t d, uint32_t a) { return (s * a + d * (32 - a) + 16) >> 5; }
+
+static uint16_t refMix(uint16_t src, uint16_t dst, uint32_t a) {
+    Rgb s = split(src), d = split(dst);
+    return join({ mixChannel(s.r, d.r, a), mixChannel(s.g, d.g, a), mixChannel(s.b, d.b, a) });
+}
+
+static uint32_t clampLevel(uint32_t a) { return a > RGB565_ALPHA_MAX ? RGB565_ALPHA_MAX : a; }
+
+static void refBlend(uint16_t* dst, const uint16_t* src, uint32_t n, uint8_t alpha, bool sw) {
+    for (uint32_t i = 0; i < n; i++)
+        dst[i] = refLoad(refMix(refLoad(src[i], sw), refLoad(dst[i], sw), clampLevel(alpha)), sw);
+}
+
+static void refBlendColor(uint16_t* dst, uint32_t n, uint16_t color, uint8_t alpha, bool sw) {
+    for (uint32_t i = 0; i < n; i++)
+        dst[i] = refLoad(refMix(color, refLoad(dst[i], sw), clampLevel(alpha)), sw);
+}
+
+static void refBlendAlpha4(uint16_t* dst, const uint16_t* src, const uint8_t* alpha4, uint32_t n, bool sw) {
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t nibble = (alpha4[i >> 1] >> (4 * (i & 1))) & 0x0F;
+        uint32_t a = (nibble * 34 + 8) >> 4;
+        dst[i] = refLoad(refMix(refLoad(src[i], sw), refLoad(dst[i], sw), a), sw);
+    }
+}
+
+static void refTint(uint16_t* dst, uint32_t n, uint16_t tint, bool sw) {
+    Rgb t = split(tint);
+    for (uint32_t i = 0; i < n; i++) {
+        Rgb d = split(refLoad(dst[i], sw));
+        dst[i] = refLoad(join({ d.r * (t.r + 1) >> 5, d.g * (t.g + 1) >> 6, d.b * (t.b + 1) >> 5 }), sw);
+    }
+}
+
+static void refScale(uint16_t* dst, uint32_t n, uint8_t level, bool sw) {
+    uint32_t l = clampLevel(level);
+    for (uint32_t i = 0; i < n; i++) {
+        Rgb d = split(refLoad(dst[i], sw));
+        dst[i] = refLoad(join({ d.r * l >> 5, d.g * l >> 5, d.b * l >> 5 }), sw);
+    }
+}
+
+static void refExpandMask(uint16_t* dst, uint32_t dstStride, const uint8_t* mask, uint32_t maskStride,
+                          uint32_t maskX, uint32_t w, uint32_t h, uint16_t color, bool sw) {
+    for (uint32_t y = 0; y < h; y++)
+        for (uint32_t x = 0; x < w; x++) {
+            uint32_t mx = maskX + x;
+            if (mask[y * maskStride + (mx >> 3)] & (0x80 >> (mx & 7))) dst[y * dstStride + x] = refLoad(color, sw);
+        }
+}
+
+// ---- correctness ----
+
+static void fill(Pcg32& rng, uint16_t* p, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) p[i] = (uint16_t)rng.next();
+}
+
+static void fillBytes(Pcg32& rng, uint8_t* p, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t r = rng.next();
+        // Whole bytes clear or set as often as mixed ones, for the mask fast paths
+        p[i] = (r & 0x300) == 0 ? 0 : (r & 0x300) == 0x100 ? 0xFF : (uint8_t)r;
+    }
+}
+
+// Rows that differ from the reference, over every byte order, level and
+// row length
+static uint64_t checkKernels(uint32_t seed, uint64_t& pixels) {
+    Pcg32 rng;
+    rng.begin(seed, 1);
+    uint64_t bad = 0;
+    pixels = 0;
+
+    uint16_t src[MAX_ROW], a[MAX_ROW], b[MAX_ROW];
+    uint8_t  alpha4[(MAX_ROW + 1) / 2];
+
+    for (int sw = 0; sw < 2; sw++)
+        for (uint32_t n = 1; n <= MAX_ROW; n++) {
+            // Levels past 32 must clamp
+            for (uint32_t level = 0; level <= RGB565_ALPHA_MAX + 2; level++) {
+                fill(rng, src, n); fill(rng, a, n); memcpy(b, a, sizeof(a));
+                rgb565Blend(a, src, n, (uint8_t)level, sw); refBlend(b, src, n, (uint8_t)level, sw);
+                bad += memcmp(a, b, n * 2) != 0;
+
+                uint16_t color = (uint16_t)rng.next();
+                fill(rng, a, n); memcpy(b, a, sizeof(a));
+                rgb565BlendColor(a, n, color, (uint8_t)level, sw); refBlendColor(b, n, color, (uint8_t)level, sw);
+                bad += memcmp(a, b, n * 2) != 0;
+
+                fill(rng, a, n); memcpy(b, a, sizeof(a));
+                rgb565Scale(a, n, (uint8_t)level, sw); refScale(b, n, (uint8_t)level, sw);
+                bad += memcmp(a, b, n * 2) != 0;
+
+                pixels += 3 * n;
+            }
+
+            // Every nibble pair, so each pixel of a pair sees every alpha
+            for (uint32_t pair = 0; pair < 256; pair++) {
+                fill(rng, src, n); fill(rng, a, n); memcpy(b, a, sizeof(a));
+                memset(alpha4, (int)pair, sizeof(alpha4));
+                rgb565BlendAlpha4(a, src, alpha4, n, sw); refBlendAlpha4(b, src, alpha4, n, sw);
+                bad += memcmp(a, b, n * 2) != 0;
+
+                fillBytes(rng, alpha4, sizeof(alpha4));
+                fill(rng, a, n); memcpy(b, a, sizeof(a));
+                rgb565BlendAlpha4(a, src, alpha4, n, sw); refBlendAlpha4(b, src, alpha4, n, sw);
+                bad += memcmp(a, b, n * 2) != 0;
+
+                uint16_t tint = pair == 0 ? 0x0000 : pair == 1 ? 0xFFFF : (uint16_t)rng.next();
+                fill(rng, a, n); memcpy(b, a, sizeof(a));
+                rgb565Tint(a, n, tint, sw); refTint(b, n, tint, sw);
+                bad += memcmp(a, b, n * 2) != 0;
+
+                pixels += 3 * n;
+            }
+
+            // Mask: every column offset, a few rows, strides wider than the rows
+            const uint32_t h = 3, stride = MAX_ROW + 5, maskStride = (8 + MAX_ROW + 7) / 8 + 1;
+            uint16_t da[h * stride], db[h * stride];
+            uint8_t  mask[h * maskStride];
+            for (uint32_t maskX = 0; maskX < 8; maskX++) {
+                fill(rng, da, h * stride); memcpy(db, da, sizeof(da));
+                fillBytes(rng, mask, sizeof(mask));
+                uint16_t color = (uint16_t)rng.next();
+                rgb565ExpandMask(da, stride, mask, maskStride, maskX, n, h, color, sw);
+                refExpandMask(db, stride, mask, maskStride, maskX, n, h, color, sw);
+                bad += memcmp(da, db, sizeof(da)) != 0;
+                pixels += h * n;
+            }
+        }
+    return bad;
+}
+
+// ---- throughput ----
+
+struct Frames {
+    std::vector<uint16_t> dst, src;
+    std::vector<uint8_t>  alpha4, mask;
+};
+
+// Megapixels per second over `frames` whole frames; the frame's rows are
+// handed over one at a time, as the sketch draws them
+template <typename Kernel>
+static double timeRows(Frames& f, uint32_t frames, Kernel kernel) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < frames; n++)
+        for (uint32_t y = 0; y < FRAME_H; y++) kernel(f, y, (uint8_t)(n & 31));
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return (double)frames * FRAME_PX / s / 1e6;
+}
+
+struct Timing {
+    const char* name;
+    double      swar, scalar;
+};
+
+static void timeKernels(Frames& f, uint32_t frames, Timing* t) {
+    const uint16_t SKY = 0x5D1F, DUSK = 0xFD20;
+    const uint32_t MS = FRAME_W / 8;
+
+#define ROW(y)        (f.dst.data() + (y) * FRAME_W)
+#define SRC(y)        (f.src.data() + (y) * FRAME_W)
+#define ALPHA4(y)     (f.alpha4.data() + (y) * FRAME_W / 2)
+    t[0] = { "blend",
+             timeRows(f, frames, [=](Frames& f, uint32_t y, uint8_t a) { rgb565Blend(ROW(y), SRC(y), FRAME_W, a, true); }),
+             timeRows(f, frames, [=](Frames& f, uint32_t y, uint8_t a) { refBlend(ROW(y), SRC(y), FRAME_W, a, true); }) };
+    t[1] = { "colour overlay",
+             timeRows(f, frames, [=](Frames& f, uint32_t y, uint8_t a) { rgb565BlendColor(ROW(y), FRAME_W, SKY, a, true); }),
+             timeRows(f, frames, [=](Frames& f, uint32_t y, uint8_t a) { refBlendColor(ROW(y), FRAME_W, SKY, a, true); }) };
+    t[2] = { "alpha4",
+             timeRows(f, frames, [=](Frames& f, uint32_t y, uint8_t) { rgb565BlendAlpha4(ROW(y), SRC(y), ALPHA4(y), FRAME_W, true); }),
+             timeRows(f, frames, [=](Frames& f, uint32_t y, uint8_t) { refBlendAlpha4(ROW(y), SRC(y), ALPHA4(y), FRAME_W, true); }) };
+    // Tint and scale have no data-dependent branch, so the frames fading
+    // towards black as they are applied again cost the same
+    t[3] = { "tint",
+             timeRows(f, frames, [=](Frames& f, uint32_t y, uint8_t) { rgb565Tint(ROW(y), FRAME_W, DUSK, true); }),
+             timeRows(f, frames, [=](Frames& f, uint32_t y, uint8_t) { refTint(ROW(y), FRAME_W, DUSK, true); }) };
+    t[4] = { "scale",
+             timeRows(f, frames, [=](Frames& f, uint32_t y, uint8_t a) { rgb565Scale(ROW(y), FRAME_W, (uint8_t)(a | 16), true); }),
+             timeRows(f, frames, [=](Frames& f, uint32_t y, uint8_t a) { refScale(ROW(y), FRAME_W, (uint8_t)(a | 16), true); }) };
+    t[5] = { "expand mask",
+             timeRows(f, frames, [=](Frames& f, uint32_t y, uint8_t) { rgb565ExpandMask(ROW(y), FRAME_W, f.mask.data() + y * MS, MS, 0, FRAME_W, 1, SKY, true); }),
+             timeRows(f, frames, [=](Frames& f, uint32_t y, uint8_t) { refExpandMask(ROW(y), FRAME_W, f.mask.data() + y * MS, MS, 0, FRAME_W, 1, SKY, true); }) };
+#undef ROW
+#undef SRC
+#undef ALPHA4
+}
+
+static void usage() {
+    fprintf(stderr, "usage: rgb565_bench [--frames N] [--seed S]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = 2000;
+    uint32_t seed   = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if      (a == "--frames" && i + 1 < argc) frames = (uint32_t)atoi(argv[++i]);
+        else if (a == "--seed" && i + 1 < argc)   seed   = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else usage();
+    }
+    if (frames == 0) usage();
+
+    uint64_t pixels;
+    uint64_t bad = checkKernels(seed, pixels);
+    printf("scalar reference: %llu pixels checked, both byte orders, rows of 1 .. %d: %llu rows differ\n\n",
+           (unsigned long long)pixels, MAX_ROW, (unsigned long long)bad);
+
+    Frames f;
+    Pcg32 rng;
+    rng.begin(seed, 2);
+    f.dst.resize(FRAME_PX);
+    f.src.resize(FRAME_PX);
+    f.alpha4.resize(FRAME_PX / 2);
+    f.mask.resize(FRAME_PX / 8);
+    fill(rng, f.dst.data(), FRAME_PX);
+    fill(rng, f.src.data(), FRAME_PX);
+    fillBytes(rng, f.alpha4.data(), FRAME_PX / 2);
+    fillBytes(rng, f.mask.data(), FRAME_PX / 8);
+
+    Timing t[6];
+    timeKernels(f, frames, t);
+
+    uint32_t sum = 0;
+    for (uint16_t p : f.dst) sum += p;
+
+    printf("%u frames of %dx%d, panel byte order (checksum %08x)\n\n", frames, FRAME_W, FRAME_H, sum);
+    printf("%-16s %12s %12s %10s\n", "kernel", "Mpx/s", "scalar", "speed-up");
+    for (const Timing& k : t)
+        printf("%-16s %12.1f %12.1f %9.2fx\n", k.name, k.swar, k.scalar, k.swar / k.scalar);
+
+    return bad ? 1 : 0;
+}
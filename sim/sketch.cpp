@@ -0,0 +1,10 @@
+// Builds the sketch as an ordinary C++ translation unit for the host.
+#include "../TamaFi/TamaFi.ino"
+
+// Pin numbers for the driver, straight from the sketch's #defines
+extern const uint8_t SIM_BTN_UP     = BTN_UP;
+extern const uint8_t SIM_BTN_OK     = BTN_OK;
+extern const uint8_t SIM_BTN_DOWN   = BTN_DOWN;
+extern const uint8_t SIM_BTN_RIGHT1 = BTN_RIGHT1;
+extern const uint8_t SIM_BTN_RIGHT2 = BTN_RIGHT2;
+extern const uint8_t SIM_BTN_RIGHT3 = BTN_RIGHT3;
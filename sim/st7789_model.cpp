@@ -0,0 +1,68 @@
+#include "st7789_model.h"
+
+#include <algorithm>
+
+const char* pushStrategyName(PushStrategy s) {
+  switch (s) {
+    case PUSH_ISSUED: return "issued";
+    case PUSH_BBOX:   return "bbox";
+    case PUSH_FULL:   return "full";
+  }
+  return "?";
+}
+
+static double wireUs(uint64_t bytes, const St7789Timing& t) {
+  return bytes * 8.0 * 1e6 / t.spiHz;
+}
+
+static void addWindow(BusStats& s, const St7789Timing& t) {
+  s.us += 3 * t.cmdUs + wireUs(3 + 8, t);
+  s.windows++;
+  s.commands += 3;
+}
+
+static void addPixels(BusStats& s, const St7789Timing& t, uint64_t px) {
+  uint64_t bytes  = px * t.bytesPerPixel;
+  uint64_t bursts = (bytes + t.fifoBytes - 1) / t.fifoBytes;
+  s.us += t.pushSetupUs + wireUs(bytes, t) + bursts * t.fifoRefillUs;
+  s.pixels += px;
+}
+
+BusStats st7789Frame(const TftOp* ops, size_t count, const St7789Timing& t,
+                     PushStrategy strategy, int panelW, int panelH) {
+  BusStats s;
+
+  if (strategy == PUSH_FULL) {
+    addWindow(s, t);
+    addPixels(s, t, (uint64_t)panelW * panelH);
+    return s;
+  }
+
+  if (strategy == PUSH_BBOX) {
+    int x0 = panelW, y0 = panelH, x1 = 0, y1 = 0;
+    for (size_t i = 0; i < count; i++) {
+      const TftOp& op = ops[i];
+      if (op.kind != TftOp::PIXELS) continue;
+      x0 = std::min<int>(x0, op.x);          y0 = std::min<int>(y0, op.y);
+      x1 = std::max<int>(x1, op.x + op.w);   y1 = std::max<int>(y1, op.y + op.h);
+    }
+    if (x1 > x0 && y1 > y0) {
+      addWindow(s, t);
+      addPixels(s, t, (uint64_t)(x1 - x0) * (y1 - y0));
+    }
+    return s;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    const TftOp& op = ops[i];
+    switch (op.kind) {
+      case TftOp::WINDOW:  addWindow(s, t); break;
+      case TftOp::PIXELS:  addPixels(s, t, op.count); break;
+      case TftOp::COMMAND:
+        s.us += t.cmdUs + wireUs(op.count, t);
+        s.commands++;
+        break;
+    }
+  }
+  return s;
+}
@@ -0,0 +1,44 @@
+#pragma once
+// Bus timing model for an ST7789 on a 4-wire SPI link, fed with the display
+// operations the firmware issued (see TftOp in stubs/TFT_eSPI.h).
+//
+// Every write is either a command byte (DC low) or data bytes (DC high):
+//
+//   address window  CASET + 4 data, RASET + 4 data, RAMWR     3 cmd + 8 data
+//   pixel push      bytesPerPixel data bytes per pixel, in FIFO-sized bursts
+//   raw command     1 byte
+//
+// Wire time is bits / spiHz. The fixed costs (DC switching, waiting for the
+// peripheral to go idle, refilling the FIFO) are per-event constants; the
+// defaults are in the range measured for TFT_eSPI on an ESP32-S3 without DMA.
+#include <stddef.h>
+#include <stdint.h>
+#include <TFT_eSPI.h>
+
+struct St7789Timing {
+  uint32_t spiHz         = SPI_FREQUENCY;   // from User_Setup.h
+  uint8_t  bytesPerPixel = 2;               // RGB565 (3 for RGB666)
+  float    cmdUs         = 0.40f;           // DC low, one byte, wait idle, DC high
+  float    pushSetupUs   = 1.00f;           // per pushPixels() call
+  uint16_t fifoBytes     = 64;              // SPI FIFO size
+  float    fifoRefillUs  = 0.15f;           // gap between FIFO bursts
+};
+
+enum PushStrategy {
+  PUSH_ISSUED,      // the op stream exactly as the firmware sent it
+  PUSH_BBOX,        // one window covering everything the frame touched
+  PUSH_FULL         // whole panel every frame
+};
+
+const char* pushStrategyName(PushStrategy s);
+
+struct BusStats {
+  double   us       = 0;      // time the bus is busy
+  uint32_t windows  = 0;
+  uint32_t commands = 0;
+  uint64_t pixels   = 0;
+};
+
+// Bus time for one frame's worth of operations
+BusStats st7789Frame(const TftOp* ops, size_t count, const St7789Timing& t,
+                     PushStrategy strategy, int panelW, int panelH);
@@ -0,0 +1,28 @@
+#pragma once
+// Host stand-in for Adafruit_NeoPixel; keeps the last shown colours.
+#include <Arduino.h>
+
+#define NEO_GRB     0x52
+#define NEO_KHZ800  0x0000
+
+class Adafruit_NeoPixel {
+public:
+  Adafruit_NeoPixel(uint16_t n, int16_t pin, uint16_t type) : _n(n) { (void)pin; (void)type; }
+  void begin() {}
+  void show() { _shows++; }
+  void clear() { memset(_px, 0, sizeof(_px)); }
+  void setBrightness(uint8_t b) { _bri = b; }
+  uint8_t getBrightness() const { return _bri; }
+  void setPixelColor(uint16_t i, uint32_t c) { if (i < _n && i < 16) _px[i] = c; }
+  uint32_t getPixelColor(uint16_t i) const { return (i < _n && i < 16) ? _px[i] : 0; }
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+  uint32_t shows() const { return _shows; }
+
+private:
+  uint16_t _n;
+  uint8_t  _bri = 255;
+  uint32_t _px[16] = {};
+  uint32_t _shows = 0;
+};
@@ -0,0 +1,105 @@
+#pragma once
+// Host stand-in for the subset of the Arduino-ESP32 core used by TamaFi.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+using std::min;
+using std::max;
+
+#define PROGMEM
+#define HIGH 1
+#define LOW  0
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+#define CHANGE  3
+#define FALLING 2
+#define RISING  1
+
+#define IRAM_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ---- Virtual clock (advanced by the simulator) ----
+uint64_t simNowUs();
+
+inline unsigned long millis() { return (unsigned long)(uint32_t)(simNowUs() / 1000); }
+inline unsigned long micros() { return (unsigned long)(uint32_t)simNowUs(); }
+void delay(uint32_t ms);
+
+// ---- Random ----
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+// ---- GPIO / LEDC ----
+void pinMode(uint8_t pin, uint8_t mode);
+int  digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+inline uint8_t digitalPinToInterrupt(uint8_t pin) { return pin; }
+
+uint32_t ledcSetup(uint8_t ch, uint32_t freq, uint8_t bits);
+void ledcAttachPin(uint8_t pin, uint8_t ch);
+void ledcWrite(uint8_t ch, uint32_t duty);
+double ledcWriteTone(uint8_t ch, double freq);
+
+// ---- FreeRTOS bits used directly by the sketch ----
+typedef uint32_t TickType_t;
+#define portTICK_PERIOD_MS 1
+void vTaskDelay(TickType_t ticks);
+
+// ---- String ----
+class String {
+public:
+  String() {}
+  String(const char* s) : _s(s ? s : "") {}
+  unsigned int length() const { return (unsigned int)_s.size(); }
+  const char* c_str() const { return _s.c_str(); }
+private:
+  std::string _s;
+};
+
+// ---- Print ----
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+
+  size_t print(const char* s) { size_t n = 0; while (*s) n += write((uint8_t)*s++); return n; }
+  size_t print(const String& s) { return print(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v)           { return printf("%d", v); }
+  size_t print(unsigned int v)  { return printf("%u", v); }
+  size_t print(long v)          { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(double v)        { return printf("%.2f", v); }
+  size_t println(const char* s = "") { size_t n = print(s); return n + write('\n'); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long) {}
+  void end() {}
+  size_t write(uint8_t c) override { return fputc(c, stderr) == EOF ? 0 : 1; }
+};
+extern HardwareSerial Serial;
+
+// ---- Core log (compiled in on the device from CORE_DEBUG_LEVEL 2) ----
+#define log_w(fmt, ...) fprintf(stderr, "[W] " fmt "\n", ##__VA_ARGS__)
+
+class EspClass {
+public:
+  uint32_t getFreeHeap() { return 200 * 1024; }
+};
+extern EspClass ESP;
@@ -0,0 +1,33 @@
+#pragma once
+// Host stand-in for ESP32 NVS Preferences (in-memory key/value store).
+#include <Arduino.h>
+
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false);
+  void end() {}
+  bool clear();
+
+  size_t putInt(const char* key, int32_t v);
+  size_t putUInt(const char* key, uint32_t v);
+  size_t putULong(const char* key, unsigned long v);
+  size_t putULong64(const char* key, uint64_t v);
+  size_t putUChar(const char* key, uint8_t v);
+  size_t putUShort(const char* key, uint16_t v);
+  size_t putBool(const char* key, bool v);
+  size_t putBytes(const char* key, const void* buf, size_t len);
+
+  int32_t       getInt(const char* key, int32_t def = 0);
+  uint32_t      getUInt(const char* key, uint32_t def = 0);
+  unsigned long getULong(const char* key, unsigned long def = 0);
+  uint64_t      getULong64(const char* key, uint64_t def = 0);
+  uint8_t       getUChar(const char* key, uint8_t def = 0);
+  uint16_t      getUShort(const char* key, uint16_t def = 0);
+  bool          getBool(const char* key, bool def = false);
+  size_t        getBytes(const char* key, void* buf, size_t maxLen);
+  size_t        getBytesLength(const char* key);
+  bool          isKey(const char* key);
+};
+
+// Simulator hooks: drop every stored key (fresh NVS)
+void simPrefsReset();
@@ -0,0 +1,284 @@
+// Host stand-in for TFT_eSPI: software rasteriser + panel op log.
+#include "TFT_eSPI.h"
+#include "glcdfont.h"
+
+#include <vector>
+
+static const int PANEL_W = 240;
+static const int PANEL_H = 240;
+
+static uint16_t           panel[PANEL_W * PANEL_H];
+static std::vector<TftOp> opLog;
+static bool               opLogOn = true;
+static uint64_t           pixelsPushed = 0;
+
+static inline uint16_t swap16(uint16_t v) { return (uint16_t)((v >> 8) | (v << 8)); }
+
+static void logOp(TftOp::Kind k, int x, int y, int w, int h, uint32_t count) {
+  if (!opLogOn) return;
+  TftOp op;
+  op.kind = k; op.x = (int16_t)x; op.y = (int16_t)y; op.w = (int16_t)w; op.h = (int16_t)h;
+  op.count = count;
+  opLog.push_back(op);
+}
+
+const uint16_t* simPanelPixels()       { return panel; }
+void            simTftLogEnable(bool on) { opLogOn = on; }
+const TftOp*    simTftLog(size_t* count) { *count = opLog.size(); return opLog.data(); }
+void            simTftLogClear()        { opLog.clear(); }
+uint64_t        simTftPixelsPushed()    { return pixelsPushed; }
+
+// ---------------------------------------------------------------------------
+// TFT_eSPI (panel)
+// ---------------------------------------------------------------------------
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h)
+  : _width(w), _height(h), _vpW(w), _vpH(h), _xWidth(w), _yHeight(h) {}
+
+void TFT_eSPI::setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h) {
+  _winX = x; _winY = y; _winW = w; _winH = h; _winPos = 0;
+  logOp(TftOp::WINDOW, x, y, w, h, 0);
+}
+
+// data is in panel byte order (what actually goes over SPI)
+void TFT_eSPI::pushPixels(const void* data, uint32_t len) {
+  const uint16_t* p = (const uint16_t*)data;
+  for (uint32_t i = 0; i < len; i++, _winPos++) {
+    if (_winW <= 0) break;
+    int32_t px = _winX + _winPos % _winW;
+    int32_t py = _winY + _winPos / _winW;
+    if (px >= 0 && py >= 0 && px < PANEL_W && py < PANEL_H)
+      panel[py * PANEL_W + px] = swap16(p[i]);
+  }
+  pixelsPushed += len;
+  logOp(TftOp::PIXELS, _winX, _winY, _winW, _winH, len);
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+  setAddrWindow(x, y, w, h);
+  std::vector<uint16_t> row((size_t)w * h);
+  for (int32_t i = 0; i < w * h; i++) row[i] = _swapBytes ? swap16(data[i]) : data[i];
+  pushPixels(row.data(), (uint32_t)(w * h));
+}
+
+void TFT_eSPI::writeCommand(uint8_t) { logOp(TftOp::COMMAND, 0, 0, 0, 0, 1); }
+void TFT_eSPI::writedata(uint8_t)    { logOp(TftOp::COMMAND, 0, 0, 0, 0, 1); }
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  if (x < _vpX || y < _vpY || x >= _vpW || y >= _vpH) return;
+  uint16_t c = swap16((uint16_t)color);
+  setAddrWindow(x, y, 1, 1);
+  pushPixels(&c, 1);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (!clipRect(x, y, w, h)) return;
+  std::vector<uint16_t> buf((size_t)w * h, swap16((uint16_t)color));
+  setAddrWindow(x, y, w, h);
+  pushPixels(buf.data(), (uint32_t)(w * h));
+}
+
+bool TFT_eSPI::clipRect(int32_t& x, int32_t& y, int32_t& w, int32_t& h) const {
+  x += _xDatum; y += _yDatum;
+  if (x < _vpX) { w -= _vpX - x; x = _vpX; }
+  if (y < _vpY) { h -= _vpY - y; y = _vpY; }
+  if (x + w > _vpW) w = _vpW - x;
+  if (y + h > _vpH) h = _vpH - y;
+  return w > 0 && h > 0;
+}
+
+void TFT_eSPI::setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum) {
+  _vpX = max<int32_t>(0, x);
+  _vpY = max<int32_t>(0, y);
+  _vpW = min<int32_t>(_width, x + w);
+  _vpH = min<int32_t>(_height, y + h);
+  _xDatum  = vpDatum ? x : 0;
+  _yDatum  = vpDatum ? y : 0;
+  _xWidth  = vpDatum ? w : _width;
+  _yHeight = vpDatum ? h : _height;
+  _vpDatum = vpDatum;
+}
+
+void TFT_eSPI::resetViewport() {
+  _vpX = _vpY = 0; _vpW = _width; _vpH = _height;
+  _xDatum = _yDatum = 0;
+  _xWidth = _width; _yHeight = _height;
+  _vpDatum = false;
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+  int32_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+  int32_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+  int32_t err = dx + dy;
+  for (;;) {
+    drawPixel(x0, y0, color);
+    if (x0 == x1 && y0 == y1) break;
+    int32_t e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x0 += sx; }
+    if (e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+void TFT_eSPI::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  int32_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+  drawPixel(x0, y0 + r, color); drawPixel(x0, y0 - r, color);
+  drawPixel(x0 + r, y0, color); drawPixel(x0 - r, y0, color);
+  while (x < y) {
+    if (f >= 0) { y--; ddy += 2; f += ddy; }
+    x++; ddx += 2; f += ddx;
+    drawPixel(x0 + x, y0 + y, color); drawPixel(x0 - x, y0 + y, color);
+    drawPixel(x0 + x, y0 - y, color); drawPixel(x0 - x, y0 - y, color);
+    drawPixel(x0 + y, y0 + x, color); drawPixel(x0 - y, y0 + x, color);
+    drawPixel(x0 + y, y0 - x, color); drawPixel(x0 - y, y0 - x, color);
+  }
+}
+
+void TFT_eSPI::fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  drawFastHLine(x0 - r, y0, 2 * r + 1, color);
+  int32_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+  while (x < y) {
+    if (f >= 0) { y--; ddy += 2; f += ddy; }
+    x++; ddx += 2; f += ddx;
+    drawFastHLine(x0 - x, y0 + y, 2 * x + 1, color);
+    drawFastHLine(x0 - x, y0 - y, 2 * x + 1, color);
+    drawFastHLine(x0 - y, y0 + x, 2 * y + 1, color);
+    drawFastHLine(x0 - y, y0 - x, 2 * y + 1, color);
+  }
+}
+
+void TFT_eSPI::drawChar(int32_t x, int32_t y, uint8_t c, uint16_t fg, uint16_t bg, uint8_t size) {
+  if (c < 0x20 || c > 0x7E) c = '?';
+  const uint8_t* glyph = &glcdFont[(c - 0x20) * 5];
+  for (int col = 0; col < 6; col++) {
+    uint8_t bits = (col < 5) ? glyph[col] : 0;
+    for (int row = 0; row < 8; row++, bits >>= 1) {
+      if (bits & 1)        fillRect(x + col * size, y + row * size, size, size, fg);
+      else if (bg != fg)   fillRect(x + col * size, y + row * size, size, size, bg);
+    }
+  }
+}
+
+size_t TFT_eSPI::write(uint8_t c) {
+  if (c == '\n') { _cursorX = 0; _cursorY += 8 * _textSize; return 1; }
+  if (c == '\r') return 1;
+  drawChar(_cursorX, _cursorY, c, _textFg, _textBg, _textSize);
+  _cursorX += 6 * _textSize;
+  return 1;
+}
+
+// ---------------------------------------------------------------------------
+// TFT_eSprite
+// ---------------------------------------------------------------------------
+TFT_eSprite::TFT_eSprite(TFT_eSPI* tft) : TFT_eSPI(0, 0), _tft(tft) {}
+
+void* TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t) {
+  deleteSprite();
+  _width = w; _height = h;
+  resetViewport();
+  if (_bpp == 1) {
+    _bitwidth = (w + 7) & ~7;
+    _img = (uint8_t*)calloc((size_t)_bitwidth * h / 8, 1);
+  } else {
+    _bpp = 16;
+    _img = (uint8_t*)calloc((size_t)w * h, 2);
+  }
+  return _img;
+}
+
+void TFT_eSprite::deleteSprite() {
+  free(_img);
+  _img = nullptr;
+}
+
+void TFT_eSprite::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  if (!_img) return;
+  x += _xDatum; y += _yDatum;
+  if (x < _vpX || y < _vpY || x >= _vpW || y >= _vpH) return;
+  if (_bpp == 1) {
+    uint8_t& b = _img[(x + y * _bitwidth) >> 3];
+    if (color) b |= (uint8_t)(0x80 >> (x & 7));
+    else       b &= (uint8_t)~(0x80 >> (x & 7));
+  } else {
+    ((uint16_t*)_img)[x + y * _width] = swap16((uint16_t)color);
+  }
+}
+
+void TFT_eSprite::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (!_img || !clipRect(x, y, w, h)) return;
+  if (_bpp == 1) {
+    for (int32_t yy = y; yy < y + h; yy++)
+      for (int32_t xx = x; xx < x + w; xx++) {
+        uint8_t& b = _img[(xx + yy * _bitwidth) >> 3];
+        if (color) b |= (uint8_t)(0x80 >> (xx & 7));
+        else       b &= (uint8_t)~(0x80 >> (xx & 7));
+      }
+    return;
+  }
+  uint16_t c = swap16((uint16_t)color);
+  uint16_t* p = (uint16_t*)_img;
+  for (int32_t yy = y; yy < y + h; yy++)
+    std::fill(p + yy * _width + x, p + yy * _width + x + w, c);
+}
+
+uint16_t TFT_eSprite::readPixel(int32_t x, int32_t y) const {
+  if (!_img || x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+  if (_bpp == 1) return (_img[(x + y * _bitwidth) >> 3] & (0x80 >> (x & 7))) ? 0xFFFF : 0;
+  return swap16(((const uint16_t*)_img)[x + y * _width]);
+}
+
+// Image data is treated as native RGB565 regardless of swap setting.
+void TFT_eSprite::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+  if (!_img || _bpp != 16) return;
+  int32_t cx = x, cy = y, cw = w, ch = h;
+  if (!clipRect(cx, cy, cw, ch)) return;
+  int32_t dx = cx - (x + _xDatum), dy = cy - (y + _yDatum);
+  uint16_t* p = (uint16_t*)_img;
+  for (int32_t r = 0; r < ch; r++) {
+    const uint16_t* src = data + (size_t)(dy + r) * w + dx;
+    uint16_t* dst = p + (size_t)(cy + r) * _width + cx;
+    for (int32_t i = 0; i < cw; i++) dst[i] = swap16(src[i]);
+  }
+}
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y) {
+  pushSprite(x, y, 0, 0, _width, _height);
+}
+
+bool TFT_eSprite::pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh) {
+  if (!_img || _bpp != 16) return false;
+  if (sx < 0) { sw += sx; tx -= sx; sx = 0; }
+  if (sy < 0) { sh += sy; ty -= sy; sy = 0; }
+  if (sx + sw > _width)  sw = _width - sx;
+  if (sy + sh > _height) sh = _height - sy;
+  if (sw < 1 || sh < 1) return false;
+
+  const uint16_t* p = (const uint16_t*)_img;
+  _tft->setAddrWindow(tx, ty, sw, sh);
+  if (sw == _width) {
+    _tft->pushPixels(p + (size_t)sy * _width, (uint32_t)(sw * sh));
+  } else {
+    std::vector<uint16_t> buf((size_t)sw * sh);
+    for (int32_t r = 0; r < sh; r++)
+      memcpy(&buf[(size_t)r * sw], p + (size_t)(sy + r) * _width + sx, (size_t)sw * 2);
+    _tft->pushPixels(buf.data(), (uint32_t)(sw * sh));
+  }
+  return true;
+}
+
+bool TFT_eSprite::pushToSprite(TFT_eSprite* dspr, int32_t x, int32_t y, uint16_t transp) {
+  if (!_img || !dspr || !dspr->_img || _bpp != 16) return false;
+  const uint16_t* src = (const uint16_t*)_img;
+  uint16_t t = swap16(transp);
+  for (int32_t ys = 0; ys < _height; ys++)
+    for (int32_t xs = 0; xs < _width; xs++) {
+      uint16_t c = src[xs + ys * _width];
+      if (c != t) dspr->drawPixel(x + xs, y + ys, swap16(c));
+    }
+  return true;
+}
@@ -0,0 +1,153 @@
+#pragma once
+// Host stand-in for the subset of TFT_eSPI used by TamaFi.
+//
+// Sprite buffers hold 16-bit pixels in panel (big-endian) byte order, as the
+// real library does, so code that touches getPointer() behaves the same.
+// Pushes to the panel land in a 240x240 native RGB565 frame and are logged
+// as display operations.
+#include <Arduino.h>
+
+// Same panel/SPI configuration the real library is built with
+#include <User_Setup.h>
+
+#define TFT_BLACK       0x0000
+#define TFT_NAVY        0x000F
+#define TFT_DARKGREEN   0x03E0
+#define TFT_MAROON      0x7800
+#define TFT_PURPLE      0x780F
+#define TFT_OLIVE       0x7BE0
+#define TFT_LIGHTGREY   0xD69A
+#define TFT_DARKGREY    0x7BEF
+#define TFT_BLUE        0x001F
+#define TFT_GREEN       0x07E0
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_WHITE       0xFFFF
+#define TFT_ORANGE      0xFDA0
+
+#define TL_DATUM 0
+
+class TFT_eSPI : public Print {
+public:
+  TFT_eSPI(int16_t w = 240, int16_t h = 240);
+  virtual ~TFT_eSPI() {}
+
+  void init() {}
+  void setRotation(uint8_t r) { _rotation = r; }
+  void setSwapBytes(bool swap) { _swapBytes = swap; }
+  bool getSwapBytes() const { return _swapBytes; }
+
+  virtual int16_t width()  const { return _width; }
+  virtual int16_t height() const { return _height; }
+
+  // Panel writes
+  void startWrite() {}
+  void endWrite() {}
+  void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h);
+  void pushPixels(const void* data, uint32_t len);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data);
+  void writeCommand(uint8_t cmd);
+  void writedata(uint8_t d);
+
+  // Text state shared by panel and sprites
+  void setTextColor(uint16_t fg) { _textFg = _textBg = fg; }
+  void setTextColor(uint16_t fg, uint16_t bg, bool = false) { _textFg = fg; _textBg = bg; }
+  void setTextSize(uint8_t s) { _textSize = s ? s : 1; }
+  void setTextFont(uint8_t) {}
+  void setTextDatum(uint8_t) {}
+  void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+  int16_t getCursorX() const { return _cursorX; }
+  int16_t getCursorY() const { return _cursorY; }
+  int16_t textWidth(const char* s) const { return (int16_t)(strlen(s) * 6 * _textSize); }
+  int16_t fontHeight() const { return (int16_t)(8 * _textSize); }
+
+  size_t write(uint8_t c) override;
+
+  // Drawing primitives (virtual so sprites draw into their buffer)
+  virtual void drawPixel(int32_t x, int32_t y, uint32_t color);
+  virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { fillRect(x, y, w, 1, color); }
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) { fillRect(x, y, 1, h, color); }
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+  void drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void fillScreen(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+
+  // Viewport clipping (coordinates stay screen-relative when vpDatum=false)
+  void setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum = true);
+  void resetViewport();
+  int32_t getViewportX() const      { return _xDatum; }
+  int32_t getViewportY() const      { return _yDatum; }
+  int32_t getViewportWidth() const  { return _xWidth; }
+  int32_t getViewportHeight() const { return _yHeight; }
+  bool    getViewportDatum() const  { return _vpDatum; }
+
+protected:
+  void drawChar(int32_t x, int32_t y, uint8_t c, uint16_t fg, uint16_t bg, uint8_t size);
+  bool clipRect(int32_t& x, int32_t& y, int32_t& w, int32_t& h) const;
+
+  int16_t  _width, _height;
+  uint8_t  _rotation = 0;
+  bool     _swapBytes = false;
+
+  int32_t  _vpX = 0, _vpY = 0, _vpW, _vpH;   // clip box [x, w) x [y, h)
+  int32_t  _xDatum = 0, _yDatum = 0;
+  int32_t  _xWidth, _yHeight;
+  bool     _vpDatum = false;
+
+  int16_t  _cursorX = 0, _cursorY = 0;
+  uint16_t _textFg = TFT_WHITE, _textBg = TFT_WHITE;
+  uint8_t  _textSize = 1;
+
+  int32_t  _winX = 0, _winY = 0, _winW = 0, _winH = 0, _winPos = 0;
+};
+
+class TFT_eSprite : public TFT_eSPI {
+public:
+  explicit TFT_eSprite(TFT_eSPI* tft);
+  ~TFT_eSprite() override { deleteSprite(); }
+
+  void  setColorDepth(int8_t bpp) { _bpp = bpp; }
+  int8_t getColorDepth() const { return _bpp; }
+  void* createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+  void  deleteSprite();
+  bool  created() const { return _img != nullptr; }
+  void* getPointer() { return _img; }
+
+  int16_t width()  const override { return _width; }
+  int16_t height() const override { return _height; }
+
+  void fillSprite(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+  void drawPixel(int32_t x, int32_t y, uint32_t color) override;
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override;
+  uint16_t readPixel(int32_t x, int32_t y) const;
+
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data);
+
+  void pushSprite(int32_t x, int32_t y);
+  bool pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh);
+  bool pushToSprite(TFT_eSprite* dspr, int32_t x, int32_t y, uint16_t transp);
+
+private:
+  TFT_eSPI* _tft;
+  int8_t    _bpp = 16;
+  uint8_t*  _img = nullptr;
+  int32_t   _bitwidth = 0;
+};
+
+// ---- Simulator access to the panel ----
+struct TftOp {
+  enum Kind : uint8_t { WINDOW, PIXELS, COMMAND } kind;
+  int16_t  x, y, w, h;
+  uint32_t count;                  // pixels for PIXELS, bytes for COMMAND
+};
+
+const uint16_t* simPanelPixels();          // native RGB565, 240x240
+void            simTftLogEnable(bool on);
+const TftOp*    simTftLog(size_t* count);
+void            simTftLogClear();
+uint64_t        simTftPixelsPushed();
@@ -0,0 +1,38 @@
+#pragma once
+// Host stand-in for the ESP32 WiFi scan API. Scan results come from the
+// simulator's environment profile and complete after a virtual delay.
+#include <Arduino.h>
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED  (-2)
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1 } wifi_mode_t;
+typedef enum { WIFI_AUTH_OPEN = 0, WIFI_AUTH_WPA2_PSK = 3 } wifi_auth_mode_t;
+
+typedef enum { ARDUINO_EVENT_WIFI_SCAN_DONE = 1, ARDUINO_EVENT_MAX } arduino_event_id_t;
+typedef void (*WiFiEventCb)(arduino_event_id_t event);
+
+struct SimNetwork {
+  int8_t rssi;
+  bool   hidden;
+  bool   open;
+};
+
+class WiFiClass {
+public:
+  bool    mode(wifi_mode_t) { return true; }
+  bool    disconnect(bool = false) { return true; }
+  int16_t scanNetworks(bool async = false);
+  int16_t scanComplete();
+  void    scanDelete();
+  int     onEvent(WiFiEventCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+
+  String           SSID(uint8_t i);
+  int32_t          RSSI(uint8_t i);
+  wifi_auth_mode_t encryptionType(uint8_t i);
+};
+extern WiFiClass WiFi;
+
+// Simulator hooks
+void simWifiSetNetworks(const SimNetwork* nets, int count);
+void simWifiSetScanTimeMs(uint32_t ms);
@@ -0,0 +1,223 @@
+// Host stand-ins: virtual clock, GPIO, LEDC, RNG, NVS, WiFi scan.
+#include <Arduino.h>
+#include <WiFi.h>
+#include <Preferences.h>
+
+#include <stdarg.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "sim_hal.h"
+
+HardwareSerial Serial;
+EspClass       ESP;
+WiFiClass      WiFi;
+
+// ---------------------------------------------------------------------------
+// Clock
+// ---------------------------------------------------------------------------
+static uint64_t clockUs = 0;
+
+static void wifiDeliverEvents();
+
+uint64_t simNowUs() { return clockUs; }
+void     simSetNowUs(uint64_t us) { if (us > clockUs) clockUs = us; wifiDeliverEvents(); }
+void     simAdvanceUs(uint64_t us) { clockUs += us; wifiDeliverEvents(); }
+
+void delay(uint32_t ms)        { simAdvanceUs((uint64_t)ms * 1000); }
+void vTaskDelay(TickType_t t)  { simAdvanceUs((uint64_t)t * 1000); }
+
+// ---------------------------------------------------------------------------
+// RNG (deterministic so runs are reproducible)
+// ---------------------------------------------------------------------------
+static uint32_t rngState = 0x12345678u;
+
+static uint32_t rngNext() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+void     simSeed(uint32_t seed) { rngState = seed ? seed : 0x12345678u; }
+uint32_t esp_random() { return rngNext(); }
+void     randomSeed(unsigned long seed) { if (seed) rngState = (uint32_t)seed; }
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  return (long)(rngNext() % (uint32_t)howbig);
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return howsmall + random(howbig - howsmall);
+}
+
+// ---------------------------------------------------------------------------
+// GPIO
+// ---------------------------------------------------------------------------
+static uint8_t pinLevel[64];
+static void  (*pinIsr[64])() = {};
+static void  (*pinIsrArg[64])(void*) = {};
+static void*   pinArg[64];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < 64 && mode == INPUT_PULLUP) pinLevel[pin] = HIGH;
+}
+int  digitalRead(uint8_t pin) { return pin < 64 ? pinLevel[pin] : LOW; }
+void digitalWrite(uint8_t pin, uint8_t val) { if (pin < 64) pinLevel[pin] = val; }
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int) {
+  if (pin < 64) pinIsr[pin] = isr;
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int) {
+  if (pin < 64) { pinIsrArg[pin] = isr; pinArg[pin] = arg; }
+}
+
+void simSetPin(uint8_t pin, uint8_t level) {
+  if (pin >= 64 || pinLevel[pin] == level) return;
+  pinLevel[pin] = level;
+  if (pinIsr[pin]) pinIsr[pin]();
+  if (pinIsrArg[pin]) pinIsrArg[pin](pinArg[pin]);
+}
+
+// ---------------------------------------------------------------------------
+// LEDC
+// ---------------------------------------------------------------------------
+static uint32_t ledcDuty[16];
+static double   ledcTone[16];
+
+uint32_t ledcSetup(uint8_t, uint32_t freq, uint8_t) { return freq; }
+void     ledcAttachPin(uint8_t, uint8_t) {}
+void     ledcWrite(uint8_t ch, uint32_t duty) { if (ch < 16) ledcDuty[ch] = duty; }
+double   ledcWriteTone(uint8_t ch, double freq) { if (ch < 16) ledcTone[ch] = freq; return freq; }
+
+uint32_t simLedcDuty(uint8_t ch) { return ch < 16 ? ledcDuty[ch] : 0; }
+double   simLedcTone(uint8_t ch) { return ch < 16 ? ledcTone[ch] : 0; }
+
+// ---------------------------------------------------------------------------
+// Print::printf
+// ---------------------------------------------------------------------------
+size_t Print::printf(const char* fmt, ...) {
+  char buf[128];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  return print(buf);
+}
+
+// ---------------------------------------------------------------------------
+// Preferences
+// ---------------------------------------------------------------------------
+static std::map<std::string, std::vector<uint8_t>> nvs;
+
+void simPrefsReset() { nvs.clear(); }
+
+bool Preferences::begin(const char*, bool) { return true; }
+bool Preferences::clear() { nvs.clear(); return true; }
+bool Preferences::isKey(const char* key) { return nvs.count(key) != 0; }
+
+template <typename T>
+static size_t putT(const char* key, T v) {
+  std::vector<uint8_t>& b = nvs[key];
+  b.assign((const uint8_t*)&v, (const uint8_t*)&v + sizeof(T));
+  return sizeof(T);
+}
+
+template <typename T>
+static T getT(const char* key, T def) {
+  auto it = nvs.find(key);
+  if (it == nvs.end() || it->second.size() != sizeof(T)) return def;
+  T v;
+  memcpy(&v, it->second.data(), sizeof(T));
+  return v;
+}
+
+size_t Preferences::putInt(const char* k, int32_t v)         { return putT(k, v); }
+size_t Preferences::putUInt(const char* k, uint32_t v)       { return putT(k, v); }
+size_t Preferences::putULong(const char* k, unsigned long v) { return putT(k, (uint32_t)v); }
+size_t Preferences::putULong64(const char* k, uint64_t v)    { return putT(k, v); }
+size_t Preferences::putUChar(const char* k, uint8_t v)       { return putT(k, v); }
+size_t Preferences::putUShort(const char* k, uint16_t v)     { return putT(k, v); }
+size_t Preferences::putBool(const char* k, bool v)           { return putT(k, (uint8_t)v); }
+
+size_t Preferences::putBytes(const char* k, const void* buf, size_t len) {
+  nvs[k].assign((const uint8_t*)buf, (const uint8_t*)buf + len);
+  return len;
+}
+
+int32_t       Preferences::getInt(const char* k, int32_t d)         { return getT(k, d); }
+uint32_t      Preferences::getUInt(const char* k, uint32_t d)       { return getT(k, d); }
+unsigned long Preferences::getULong(const char* k, unsigned long d) { return getT(k, (uint32_t)d); }
+uint64_t      Preferences::getULong64(const char* k, uint64_t d)    { return getT(k, d); }
+uint8_t       Preferences::getUChar(const char* k, uint8_t d)       { return getT(k, d); }
+uint16_t      Preferences::getUShort(const char* k, uint16_t d)     { return getT(k, d); }
+bool          Preferences::getBool(const char* k, bool d)           { return getT(k, (uint8_t)d) != 0; }
+
+size_t Preferences::getBytesLength(const char* k) {
+  auto it = nvs.find(k);
+  return it == nvs.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char* k, void* buf, size_t maxLen) {
+  auto it = nvs.find(k);
+  if (it == nvs.end() || it->second.size() > maxLen) return 0;
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+// ---------------------------------------------------------------------------
+// WiFi scan
+// ---------------------------------------------------------------------------
+static std::vector<SimNetwork> envNets;
+static uint32_t scanTimeMs   = 2500;
+static uint64_t scanDoneUs   = 0;
+static bool     scanning     = false;
+static bool     haveResults  = false;
+static bool     scanEventDue = false;
+static std::vector<std::pair<WiFiEventCb, arduino_event_id_t>> wifiEventCbs;
+
+// The driver's event task fires SCAN_DONE once the scan time has passed
+static void wifiDeliverEvents() {
+  if (!scanEventDue || clockUs < scanDoneUs) return;
+  scanEventDue = false;
+  for (auto& cb : wifiEventCbs)
+    if (cb.second == ARDUINO_EVENT_WIFI_SCAN_DONE || cb.second == ARDUINO_EVENT_MAX)
+      cb.first(ARDUINO_EVENT_WIFI_SCAN_DONE);
+}
+
+int WiFiClass::onEvent(WiFiEventCb cb, arduino_event_id_t event) {
+  wifiEventCbs.push_back({ cb, event });
+  return (int)wifiEventCbs.size();
+}
+
+void simWifiSetNetworks(const SimNetwork* nets, int count) { envNets.assign(nets, nets + count); }
+void simWifiSetScanTimeMs(uint32_t ms) { scanTimeMs = ms; }
+bool simWifiScanPending(uint64_t* doneUs) { *doneUs = scanDoneUs; return scanning; }
+
+int16_t WiFiClass::scanNetworks(bool) {
+  scanning     = true;
+  haveResults  = false;
+  scanEventDue = true;
+  scanDoneUs  = clockUs + (uint64_t)scanTimeMs * 1000;
+  return WIFI_SCAN_RUNNING;
+}
+
+int16_t WiFiClass::scanComplete() {
+  if (scanning && clockUs >= scanDoneUs) { scanning = false; haveResults = true; }
+  if (scanning) return WIFI_SCAN_RUNNING;
+  return haveResults ? (int16_t)envNets.size() : WIFI_SCAN_FAILED;
+}
+
+void WiFiClass::scanDelete() { haveResults = false; }
+
+String WiFiClass::SSID(uint8_t i) {
+  return (i < envNets.size() && !envNets[i].hidden) ? String("net") : String("");
+}
+int32_t WiFiClass::RSSI(uint8_t i) { return i < envNets.size() ? envNets[i].rssi : -100; }
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t i) {
+  return (i < envNets.size() && envNets[i].open) ? WIFI_AUTH_OPEN : WIFI_AUTH_WPA2_PSK;
+}
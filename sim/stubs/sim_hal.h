@@ -0,0 +1,11 @@
+#pragma once
+// Simulator-side controls for the host stand-ins.
+#include <stdint.h>
+
+void     simSetNowUs(uint64_t us);
+void     simAdvanceUs(uint64_t us);
+void     simSeed(uint32_t seed);
+void     simSetPin(uint8_t pin, uint8_t level);
+uint32_t simLedcDuty(uint8_t ch);
+double   simLedcTone(uint8_t ch);
+bool     simWifiScanPending(uint64_t* doneUs);
@@ -0,0 +1,256 @@
+// Runs a recorded session again (trace.h): the real setup(), logic and
+// render steps on the host stand-ins, in the order they ran on the device,
+// every input taken from the trace. Each frame is checked against the
+// CRC the device recorded, so a replay that gets to the end reproduced
+// the session bit for bit; one that does not says at which step it
+// parted. Nothing waits for real time.
+//
+// With --record the host makes the trace itself: a seeded session of
+// random button presses under a seeded neighbourhood, stepped by deadline
+// the way the two tasks run on the device. The replay then starts from
+// another seed, no networks and empty NVS, so only the trace can make it
+// match.
+//
+//   ./tamafi_replay TRACE [-o DIR]
+//   ./tamafi_replay --record TRACE [--minutes N] [--seed S]
+//
+//   -o DIR        write every replayed frame to DIR as PPM
+//   --minutes N   length of the recorded session (default: 10)
+//   --seed S      seed for presses, random() and the neighbourhood (default: 1)
+#include <Arduino.h>
+#include <WiFi.h>
+#include <TFT_eSPI.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#include "sim_hal.h"
+#include "../TamaFi/ui.h"
+#include "../TamaFi/power.h"
+#include "../TamaFi/monotonic.h"
+#include "../TamaFi/trace.h"
+
+void setup();
+void logicStep();
+void renderStep();
+uint32_t logicIdleMs();
+
+extern const uint8_t SIM_BTN_UP, SIM_BTN_OK, SIM_BTN_DOWN;
+extern const uint8_t SIM_BTN_RIGHT1, SIM_BTN_RIGHT2, SIM_BTN_RIGHT3;
+
+static const int PANEL_W = 240;
+static const int PANEL_H = 240;
+
+static FILE* traceOut;
+
+static uint32_t rngState = 1;
+
+static uint32_t rngNext() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static uint32_t rngRange(uint32_t lo, uint32_t hi) {
+    return lo + rngNext() % (hi - lo);
+}
+
+static void writeFrame(const std::string& dir, uint32_t n) {
+    char name[32];
+    snprintf(name, sizeof(name), "/frame_%06u.ppm", n);
+    FILE* f = fopen((dir + name).c_str(), "wb");
+    if (!f) { fprintf(stderr, "cannot write %s%s\n", dir.c_str(), name); return; }
+
+    fprintf(f, "P6\n%d %d\n255\n", PANEL_W, PANEL_H);
+    const uint16_t* p = simPanelPixels();
+    for (int i = 0; i < PANEL_W * PANEL_H; i++) {
+        uint16_t c = p[i];
+        uint8_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+        uint8_t rgb[3] = { (uint8_t)((r << 3) | (r >> 2)), (uint8_t)((g << 2) | (g >> 4)), (uint8_t)((b << 3) | (b >> 2)) };
+        fwrite(rgb, 1, 3, f);
+    }
+    fclose(f);
+}
+
+// ---------------------------------------------------------------------------
+// Recording
+// ---------------------------------------------------------------------------
+static uint64_t sleepUntil(PowerDomain d, Screen s, uint32_t ms) {
+    powerSleep(d, s, ms);
+    if (ms == NO_DEADLINE) return UINT64_MAX;
+    return simNowUs() + (uint64_t)std::max<uint32_t>(ms, 1) * 1000;
+}
+
+static uint8_t pressPin() {
+    const uint8_t pins[] = { SIM_BTN_OK, SIM_BTN_OK, SIM_BTN_OK, SIM_BTN_UP, SIM_BTN_DOWN,
+                             SIM_BTN_DOWN, SIM_BTN_RIGHT1, SIM_BTN_RIGHT2, SIM_BTN_RIGHT3 };
+    return pins[rngNext() % (sizeof(pins) / sizeof(pins[0]))];
+}
+
+// Mostly taps, now and then a hold long enough to count as a long press
+static uint64_t holdUs() {
+    return (rngNext() % 8 ? rngRange(40, 250) : rngRange(900, 1500)) * 1000ull;
+}
+
+static uint64_t gapUs() {
+    return rngRange(300, 6000) * 1000ull;
+}
+
+static void traceSink(const uint8_t* data, size_t len) {
+    fwrite(data, 1, len, traceOut);
+}
+
+static int record(const std::string& path, double minutes, uint32_t seed) {
+    traceOut = fopen(path.c_str(), "wb");
+    if (!traceOut) { fprintf(stderr, "cannot write %s\n", path.c_str()); return 1; }
+
+    rngState = seed ? seed : 1;
+    std::vector<SimNetwork> nets(rngRange(0, 16));
+    for (SimNetwork& n : nets) n = { (int8_t)-(int)rngRange(40, 95), rngNext() % 8 == 0, rngNext() % 4 == 0 };
+    simWifiSetNetworks(nets.data(), (int)nets.size());
+    simSeed(seed);
+
+    traceRecord(traceSink);
+    setup();
+
+    uint64_t start = simNowUs();
+    uint64_t end   = start + (uint64_t)(minutes * 60e6);
+    uint64_t logicAt = start, renderAt = start;
+    uint64_t pressAt = start + gapUs(), releaseAt = UINT64_MAX;
+    uint8_t  held = 0;
+    uint32_t logicSteps = 0, frames = 0, presses = 0;
+
+    for (;;) {
+        if (powerTakeKick(POWER_LOGIC))  logicAt  = simNowUs();
+        if (powerTakeKick(POWER_RENDER)) renderAt = simNowUs();
+
+        uint64_t next = std::min({ logicAt, renderAt, pressAt, releaseAt });
+        uint64_t scanAt;
+        if (simWifiScanPending(&scanAt) && scanAt > simNowUs()) next = std::min(next, scanAt);
+        if (next >= end) break;
+        simSetNowUs(next);                 // may deliver the scan-done event
+
+        if (simNowUs() >= releaseAt) {
+            simSetPin(held, HIGH);
+            releaseAt = UINT64_MAX;
+            pressAt   = simNowUs() + gapUs();
+        } else if (simNowUs() >= pressAt) {
+            held = pressPin();
+            simSetPin(held, LOW);
+            presses++;
+            pressAt   = UINT64_MAX;
+            releaseAt = simNowUs() + holdUs();
+        }
+
+        if (powerTakeKick(POWER_LOGIC)) logicAt = simNowUs();
+        if (simNowUs() >= logicAt) {
+            powerWake(POWER_LOGIC, currentScreen);
+            logicStep();
+            logicSteps++;
+            logicAt = sleepUntil(POWER_LOGIC, currentScreen, logicIdleMs());
+        }
+
+        if (powerTakeKick(POWER_RENDER)) renderAt = simNowUs();
+        if (simNowUs() >= renderAt) {
+            powerWake(POWER_RENDER, uiShownScreen());
+            renderStep();
+            frames++;
+            renderAt = sleepUntil(POWER_RENDER, uiShownScreen(), uiIdleMs());
+        }
+    }
+
+    traceStop();
+    long bytes = ftell(traceOut);
+    fclose(traceOut);
+
+    printf("recorded %.1f min, %u presses, %zu networks: %u logic steps, %u frames, %ld bytes (%.0f B/min)\n",
+           minutes, presses, nets.size(), logicSteps, frames, bytes, bytes / minutes);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Replaying
+// ---------------------------------------------------------------------------
+static int replay(const std::string& path, const std::string& outDir) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) { fprintf(stderr, "cannot read %s\n", path.c_str()); return 1; }
+    std::vector<uint8_t> data;
+    uint8_t buf[65536];
+    for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0; ) data.insert(data.end(), buf, buf + n);
+    fclose(f);
+
+    if (!traceReplay(data.data(), data.size())) {
+        fprintf(stderr, "%s is not a TamaFi trace (version %d)\n", path.c_str(), TRACE_VERSION);
+        return 1;
+    }
+    if (!outDir.empty()) mkdir(outDir.c_str(), 0755);
+
+    // Nothing the live stand-ins offer may leak in
+    simSeed(0xBAD5EED);
+    simWifiSetNetworks(nullptr, 0);
+
+    uint32_t    logicSteps = 0, frames = 0;
+    bool        booted  = false;
+    TimeUs      startUs = -1;
+    TraceStream s;
+
+    auto t0 = std::chrono::steady_clock::now();
+    while (traceNextStep(s)) {
+        if (s == TRACE_RENDER) {
+            renderStep();
+            if (!outDir.empty()) writeFrame(outDir, frames);
+            frames++;
+        } else {
+            if (!booted) setup();
+            else         logicStep();
+            logicSteps += booted;
+            booted = true;
+        }
+        if (startUs < 0) startUs = traceReplayUs();
+        simSetNowUs(traceReplayUs());
+        if (traceError()) break;
+    }
+    double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    double spanS = (traceReplayUs() - std::max<TimeUs>(startUs, 0)) / 1e6;
+
+    printf("replayed %u logic steps and %u frames, %.1f min of device time in %.2f s (%.0fx real time)\n",
+           logicSteps, frames, spanS / 60, wallS, wallS > 0 ? spanS / wallS : 0.0);
+    if (const char* err = traceError()) {
+        printf("diverged at %s\n", err);
+        return 1;
+    }
+    printf("every frame matches the recording\n");
+    return 0;
+}
+
+static void usage() {
+    fprintf(stderr, "usage: tamafi_replay TRACE [-o DIR]\n"
+                    "       tamafi_replay --record TRACE [--minutes N] [--seed S]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    std::string trace, outDir;
+    bool        recording = false;
+    double      minutes   = 10;
+    uint32_t    seed      = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if      (a == "-o" && i + 1 < argc)         outDir    = argv[++i];
+        else if (a == "--record" && i + 1 < argc) { recording = true; trace = argv[++i]; }
+        else if (a == "--minutes" && i + 1 < argc)  minutes   = atof(argv[++i]);
+        else if (a == "--seed" && i + 1 < argc)     seed      = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (a[0] != '-' && trace.empty())      trace     = a;
+        else usage();
+    }
+    if (trace.empty() || minutes <= 0) usage();
+
+    // The firmware's monotonic clock is the virtual one
+    monoSetSource([]() -> TimeUs { return (TimeUs)simNowUs(); });
+
+    return recording ? record(trace, minutes, seed) : replay(trace, outDir);
+}
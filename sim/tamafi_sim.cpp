@@ -0,0 +1,516 @@
+// Headless TamaFi: runs the real setup()/loop() against the host stand-ins
+// under a virtual clock, walks through every Screen, dumps one image per
+// screen and reports per-screen compose time and pixels pushed.
+//
+// Every frame's display operations also go through the ST7789 bus model
+// (st7789_model.h) to project frame time, FPS and bus utilisation on the
+// device for one or more SPI clocks and push strategies.
+//
+// With --power, each screen is also left alone for a while with the logic
+// and render steps scheduled the way the two tasks run on the device: each
+// sleeps until its own next deadline or until it is kicked. That gives the
+// wake-ups per minute per screen, and a render duty cycle from the modeled
+// bus time (compose time is not modeled, so it is a lower bound).
+//
+//   ./tamafi_sim [-o DIR] [--png] [--bench N] [--golden DIR]
+//                [--spi HZ[,HZ..]] [--push issued|bbox|full[,..]] [--bpp N]
+//                [--power SECONDS] [--start MS]
+//
+//   -o DIR        where frames are written (default: frames)
+//   --png         write PNG instead of PPM
+//   --bench N     frames timed per screen (default: 60)
+//   --golden DIR  compare every frame with DIR/<name>.ppm, exit 1 on a mismatch
+//   --spi HZ,..   SPI clocks to model (default: SPI_FREQUENCY from User_Setup.h)
+//   --push S,..   push strategies to model (default: issued,full)
+//   --bpp N       bytes per pixel on the wire (2 = RGB565, 3 = RGB666)
+//   --power S     idle S virtual seconds on every screen and report wake-ups
+//   --start MS    uptime at power-on; 4294930000 runs the walk across the
+//                 point where a 32-bit millis() wraps (~49.7 days)
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <WiFi.h>
+#include <Preferences.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#include "sim_hal.h"
+#include "st7789_model.h"
+#include "../TamaFi/ui.h"
+#include "../TamaFi/power.h"
+#include "../TamaFi/monotonic.h"
+
+void setup();
+void loop();
+void logicStep();
+void renderStep();
+uint32_t logicIdleMs();
+
+extern const uint8_t SIM_BTN_UP, SIM_BTN_OK, SIM_BTN_DOWN;
+extern PetSim        petSim;
+
+static const int      PANEL_W  = 240;
+static const int      PANEL_H  = 240;
+static const uint64_t FRAME_US = 16000;     // virtual time per loop() pass
+static const double   FRAME_BUDGET_US = 1e6 / 60;
+
+static std::string outDir    = "frames";
+static std::string goldenDir;
+static bool        writePng  = false;
+static int         benchFrames = 60;
+static int         goldenFailures = 0;
+static int         powerSeconds = 0;
+static uint64_t    startMs      = 0;
+
+// ---------------------------------------------------------------------------
+// Bus model bookkeeping: one accumulator per (SPI clock, push strategy)
+// ---------------------------------------------------------------------------
+static St7789Timing              busTiming;
+static std::vector<uint32_t>     spiClocks;
+static std::vector<PushStrategy> strategies;
+
+struct BusAccum {
+    double sum = 0, max = 0;
+    int    n = 0;
+    void add(double us) { sum += us; max = std::max(max, us); n++; }
+    double avg() const { return n ? sum / n : 0; }
+};
+
+struct BusRow {
+    const char*  screen;
+    uint32_t     hz;
+    PushStrategy strategy;
+    BusAccum     bus;         // benchmark frames
+};
+static std::vector<BusRow> busRows;
+
+// Feed the ops logged since the last call into every model configuration
+static void modelFrame(BusRow* rows) {
+    size_t n;
+    const TftOp* ops = simTftLog(&n);
+    if (rows) {
+        for (size_t c = 0; c < spiClocks.size() * strategies.size(); c++) {
+            St7789Timing t = busTiming;
+            t.spiHz = rows[c].hz;
+            BusStats st = st7789Frame(ops, n, t, rows[c].strategy, PANEL_W, PANEL_H);
+            rows[c].bus.add(st.us);
+        }
+    }
+    simTftLogClear();
+}
+
+// ---------------------------------------------------------------------------
+// Image output
+// ---------------------------------------------------------------------------
+static std::vector<uint8_t> panelRgb() {
+    std::vector<uint8_t> rgb((size_t)PANEL_W * PANEL_H * 3);
+    const uint16_t* p = simPanelPixels();
+    for (int i = 0; i < PANEL_W * PANEL_H; i++) {
+        uint16_t c = p[i];
+        uint8_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+        rgb[i * 3 + 0] = (uint8_t)((r << 3) | (r >> 2));
+        rgb[i * 3 + 1] = (uint8_t)((g << 2) | (g >> 4));
+        rgb[i * 3 + 2] = (uint8_t)((b << 3) | (b >> 2));
+    }
+    return rgb;
+}
+
+static std::string ppmHeader() {
+    char hdr[32];
+    snprintf(hdr, sizeof(hdr), "P6\n%d %d\n255\n", PANEL_W, PANEL_H);
+    return hdr;
+}
+
+static void writePpm(const std::string& path, const std::vector<uint8_t>& rgb) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) { fprintf(stderr, "cannot write %s\n", path.c_str()); return; }
+    std::string hdr = ppmHeader();
+    fwrite(hdr.data(), 1, hdr.size(), f);
+    fwrite(rgb.data(), 1, rgb.size(), f);
+    fclose(f);
+}
+
+static uint32_t crc32(const uint8_t* d, size_t n, uint32_t crc = 0) {
+    crc = ~crc;
+    while (n--) {
+        crc ^= *d++;
+        for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static void putBe32(std::vector<uint8_t>& v, uint32_t x) {
+    v.push_back(x >> 24); v.push_back(x >> 16); v.push_back(x >> 8); v.push_back(x);
+}
+
+static void pngChunk(FILE* f, const char* type, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> buf;
+    putBe32(buf, (uint32_t)data.size());
+    buf.insert(buf.end(), type, type + 4);
+    buf.insert(buf.end(), data.begin(), data.end());
+    putBe32(buf, crc32(buf.data() + 4, buf.size() - 4));
+    fwrite(buf.data(), 1, buf.size(), f);
+}
+
+// Uncompressed (stored) deflate keeps this dependency-free
+static void writePngFile(const std::string& path, const std::vector<uint8_t>& rgb) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) { fprintf(stderr, "cannot write %s\n", path.c_str()); return; }
+
+    static const uint8_t sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    fwrite(sig, 1, 8, f);
+
+    std::vector<uint8_t> ihdr;
+    putBe32(ihdr, PANEL_W);
+    putBe32(ihdr, PANEL_H);
+    ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 });     // 8-bit RGB
+    pngChunk(f, "IHDR", ihdr);
+
+    std::vector<uint8_t> raw;
+    for (int y = 0; y < PANEL_H; y++) {
+        raw.push_back(0);                            // filter: none
+        raw.insert(raw.end(), rgb.begin() + y * PANEL_W * 3, rgb.begin() + (y + 1) * PANEL_W * 3);
+    }
+
+    std::vector<uint8_t> z = { 0x78, 0x01 };
+    for (size_t pos = 0; pos < raw.size(); ) {
+        size_t len = std::min<size_t>(65535, raw.size() - pos);
+        z.push_back(pos + len == raw.size() ? 1 : 0);
+        z.push_back(len & 0xFF);  z.push_back(len >> 8);
+        z.push_back(~len & 0xFF); z.push_back((~len >> 8) & 0xFF);
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t c : raw) { a = (a + c) % 65521; b = (b + a) % 65521; }
+    putBe32(z, (b << 16) | a);
+    pngChunk(f, "IDAT", z);
+    pngChunk(f, "IEND", {});
+    fclose(f);
+}
+
+static void compareGolden(const std::string& name, const std::vector<uint8_t>& rgb) {
+    std::string path = goldenDir + "/" + name + ".ppm";
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        printf("  golden: %s missing\n", path.c_str());
+        goldenFailures++;
+        return;
+    }
+    std::string hdr = ppmHeader();
+    std::vector<uint8_t> ref(hdr.size() + rgb.size());
+    size_t n = fread(ref.data(), 1, ref.size(), f);
+    fclose(f);
+
+    int diff = 0;
+    if (n != ref.size() || memcmp(ref.data(), hdr.data(), hdr.size()) != 0) {
+        diff = PANEL_W * PANEL_H;
+    } else {
+        for (int i = 0; i < PANEL_W * PANEL_H; i++)
+            if (memcmp(&ref[hdr.size() + i * 3], &rgb[i * 3], 3) != 0) diff++;
+    }
+    if (diff) {
+        printf("  golden: %s differs in %d px\n", name.c_str(), diff);
+        goldenFailures++;
+    }
+}
+
+static void dumpFrame(const std::string& name) {
+    std::vector<uint8_t> rgb = panelRgb();
+    if (writePng) writePngFile(outDir + "/" + name + ".png", rgb);
+    else          writePpm(outDir + "/" + name + ".ppm", rgb);
+    if (!goldenDir.empty()) compareGolden(name, rgb);
+}
+
+// ---------------------------------------------------------------------------
+// Driving the firmware
+// ---------------------------------------------------------------------------
+static void frames(int n) {
+    for (int i = 0; i < n; i++) {
+        loop();
+        simAdvanceUs(FRAME_US);
+        modelFrame(nullptr);
+    }
+}
+
+static void press(uint8_t pin) {
+    simSetPin(pin, LOW);
+    frames(1);
+    simSetPin(pin, HIGH);
+    frames(1);
+}
+
+static bool runUntil(Screen s, int maxFrames) {
+    for (int i = 0; i < maxFrames && currentScreen != s; i++) frames(1);
+    return currentScreen == s;
+}
+
+static void selectMainMenu(int index) {
+    for (int i = 0; i < 8 && mainMenuIndex != index; i++) press(SIM_BTN_DOWN);
+}
+
+static const char* screenName(Screen s) {
+    switch (s) {
+        case SCREEN_BOOT:        return "boot";
+        case SCREEN_HATCH:       return "hatch";
+        case SCREEN_HOME:        return "home";
+        case SCREEN_MENU:        return "menu";
+        case SCREEN_PET_STATUS:  return "pet_status";
+        case SCREEN_ENVIRONMENT: return "environment";
+        case SCREEN_SYSINFO:     return "sysinfo";
+        case SCREEN_CONTROLS:    return "controls";
+        case SCREEN_SETTINGS:    return "settings";
+        case SCREEN_DIAGNOSTICS: return "diagnostics";
+        case SCREEN_GAMEOVER:    return "gameover";
+    }
+    return "?";
+}
+
+// ---------------------------------------------------------------------------
+// Deadline-driven stepping (--power)
+// ---------------------------------------------------------------------------
+struct PowerRow {
+    const char* screen;
+    uint32_t    spanMs;
+    PowerReport r;            // accumulated during the window only
+};
+static std::vector<PowerRow> powerRows;
+
+static uint64_t sleepUntil(PowerDomain d, Screen s, uint32_t ms) {
+    powerSleep(d, s, ms);
+    if (ms == NO_DEADLINE) return UINT64_MAX;
+    return simNowUs() + (uint64_t)std::max<uint32_t>(ms, 1) * 1000;
+}
+
+// The render step holds the clock for its modeled bus time
+static void renderBusy() {
+    size_t n;
+    const TftOp* ops = simTftLog(&n);
+    St7789Timing t = busTiming;
+    t.spiHz = spiClocks[0];
+    simAdvanceUs((uint64_t)st7789Frame(ops, n, t, PUSH_ISSUED, PANEL_W, PANEL_H).us);
+    simTftLogClear();
+}
+
+static void measurePower(Screen s) {
+    for (int d = 0; d < POWER_DOMAINS; d++) {
+        powerWake((PowerDomain)d, s);
+        powerSleep((PowerDomain)d, s, 0);
+    }
+    simTftLogClear();
+    PowerReport before = powerReport(s);
+
+    uint64_t start = simNowUs();
+    uint64_t end   = start + (uint64_t)powerSeconds * 1000000;
+    uint64_t logicAt = start, renderAt = start;
+
+    for (;;) {
+        if (powerTakeKick(POWER_LOGIC))  logicAt  = simNowUs();
+        if (powerTakeKick(POWER_RENDER)) renderAt = simNowUs();
+
+        uint64_t next = std::min(logicAt, renderAt);
+        uint64_t scanAt;
+        if (simWifiScanPending(&scanAt) && scanAt > simNowUs()) next = std::min(next, scanAt);
+        if (next >= end) break;
+        simSetNowUs(next);                 // may deliver the scan-done event
+
+        if (powerTakeKick(POWER_LOGIC)) logicAt = simNowUs();
+        if (simNowUs() >= logicAt) {
+            powerWake(POWER_LOGIC, currentScreen);
+            logicStep();
+            logicAt = sleepUntil(POWER_LOGIC, currentScreen, logicIdleMs());
+        }
+
+        if (powerTakeKick(POWER_RENDER)) renderAt = simNowUs();
+        if (simNowUs() >= renderAt) {
+            powerWake(POWER_RENDER, uiShownScreen());
+            renderStep();
+            renderBusy();
+            renderAt = sleepUntil(POWER_RENDER, uiShownScreen(), uiIdleMs());
+        }
+    }
+    simSetNowUs(end);
+
+    PowerReport after = powerReport(s);
+    PowerRow row;
+    row.screen = screenName(s);
+    row.spanMs = (uint32_t)((end - start) / 1000);
+    for (int d = 0; d < POWER_DOMAINS; d++) {
+        row.r.busyMs[d] = after.busyMs[d] - before.busyMs[d];
+        row.r.wakes[d]  = after.wakes[d]  - before.wakes[d];
+    }
+    powerRows.push_back(row);
+}
+
+static void printPowerReport() {
+    printf("\nDeadline-driven sleep (%d s per screen, render duty from bus time at %.1f MHz)\n",
+           powerSeconds, spiClocks[0] / 1e6);
+    printf("%-12s %12s %12s %12s %12s\n",
+           "screen", "logic/min", "render/min", "wakes/min", "render duty");
+    for (const PowerRow& p : powerRows) {
+        double min = p.spanMs / 60000.0;
+        printf("%-12s %12.1f %12.1f %12.1f %11.2f%%\n", p.screen,
+               p.r.wakes[POWER_LOGIC] / min, p.r.wakes[POWER_RENDER] / min,
+               (p.r.wakes[POWER_LOGIC] + p.r.wakes[POWER_RENDER]) / min,
+               100.0 * p.r.busyMs[POWER_RENDER] / p.spanMs);
+    }
+}
+
+// Let the transition finish, dump the frame, then time uiDrawScreen() alone
+static void capture() {
+    frames(30);
+
+    Screen s = currentScreen;
+    dumpFrame(screenName(s));
+
+    size_t first = busRows.size();
+    for (uint32_t hz : spiClocks)
+        for (PushStrategy st : strategies) {
+            BusRow r;
+            r.screen = screenName(s); r.hz = hz; r.strategy = st;
+            busRows.push_back(r);
+        }
+
+    uint64_t totalNs = 0, maxNs = 0, totalPx = 0, maxPx = 0;
+    for (int i = 0; i < benchFrames; i++) {
+        uint64_t px0 = simTftPixelsPushed();
+        auto t0 = std::chrono::steady_clock::now();
+        uiDrawScreen();
+        auto t1 = std::chrono::steady_clock::now();
+        simAdvanceUs(FRAME_US);
+
+        uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        uint64_t px = simTftPixelsPushed() - px0;
+        modelFrame(&busRows[first]);
+        totalNs += ns; maxNs = std::max(maxNs, ns);
+        totalPx += px; maxPx = std::max(maxPx, px);
+    }
+
+    printf("%-12s %10.1f %10.1f %10llu %10llu %7.1f%%\n", screenName(s),
+           totalNs / 1000.0 / benchFrames, maxNs / 1000.0,
+           (unsigned long long)(totalPx / benchFrames), (unsigned long long)maxPx,
+           100.0 * totalPx / benchFrames / (PANEL_W * PANEL_H));
+
+    if (powerSeconds) measurePower(s);
+}
+
+// Projected device-side bus cost. fps is the bus-bound ceiling; "budget" is
+// the share of a 60 fps frame the bus alone needs (over 100% cannot keep up).
+static void printBusReport() {
+    printf("\nST7789 bus model (%u B/px, cmd %.2f us, push setup %.2f us)\n",
+           busTiming.bytesPerPixel, busTiming.cmdUs, busTiming.pushSetupUs);
+    printf("%-12s %6s %-7s %10s %10s %8s %7s\n",
+           "screen", "MHz", "push", "avg ms", "max ms", "fps", "budget");
+    for (const BusRow& r : busRows) {
+        double fps = r.bus.avg() > 0 ? 1e6 / r.bus.avg() : 0;
+        printf("%-12s %6.1f %-7s %10.2f %10.2f %8.1f %6.1f%%\n",
+               r.screen, r.hz / 1e6, pushStrategyName(r.strategy),
+               r.bus.avg() / 1000.0, r.bus.max / 1000.0,
+               fps, 100.0 * r.bus.avg() / FRAME_BUDGET_US);
+    }
+}
+
+static void usage() {
+    fprintf(stderr, "usage: tamafi_sim [-o DIR] [--png] [--bench N] [--golden DIR] "
+                    "[--spi HZ[,HZ..]] [--bpp N] [--power SECONDS] [--start MS]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if      (a == "-o" && i + 1 < argc)        outDir = argv[++i];
+        else if (a == "--png")                     writePng = true;
+        else if (a == "--bench" && i + 1 < argc)   benchFrames = std::max(1, atoi(argv[++i]));
+        else if (a == "--golden" && i + 1 < argc)  goldenDir = argv[++i];
+        else if (a == "--power" && i + 1 < argc)   powerSeconds = std::max(0, atoi(argv[++i]));
+        else if (a == "--start" && i + 1 < argc)   startMs = strtoull(argv[++i], nullptr, 10);
+        else if (a == "--bpp" && i + 1 < argc)     busTiming.bytesPerPixel = (uint8_t)constrain(atoi(argv[++i]), 1, 4);
+        else if (a == "--spi" && i + 1 < argc) {
+            for (char* tok = strtok(argv[++i], ","); tok; tok = strtok(nullptr, ","))
+                if (atof(tok) > 0) spiClocks.push_back((uint32_t)atof(tok));
+        }
+        else if (a == "--push" && i + 1 < argc) {
+            for (char* tok = strtok(argv[++i], ","); tok; tok = strtok(nullptr, ",")) {
+                if      (!strcmp(tok, "issued")) strategies.push_back(PUSH_ISSUED);
+                else if (!strcmp(tok, "bbox"))   strategies.push_back(PUSH_BBOX);
+                else if (!strcmp(tok, "full"))   strategies.push_back(PUSH_FULL);
+                else usage();
+            }
+        }
+        else usage();
+    }
+    if (spiClocks.empty())  spiClocks.push_back(busTiming.spiHz);
+    if (strategies.empty()) strategies = { PUSH_ISSUED, PUSH_FULL };
+    mkdir(outDir.c_str(), 0755);
+
+    // A small neighbourhood so the environment page has something to show
+    static const SimNetwork nets[] = {
+        { -48, false, false }, { -61, false, false }, { -67, false, true },
+        { -74, true,  false }, { -82, false, false }, { -90, false, true }
+    };
+    simWifiSetNetworks(nets, sizeof(nets) / sizeof(nets[0]));
+    simSeed(1);
+
+    // The firmware's monotonic clock is the virtual one
+    monoSetSource([]() -> TimeUs { return (TimeUs)simNowUs(); });
+    simSetNowUs(startMs * 1000);
+
+    setup();
+
+    printf("%-12s %10s %10s %10s %10s %8s\n",
+           "screen", "avg us", "max us", "avg px", "max px", "of full");
+
+    capture();                                           // boot
+
+    press(SIM_BTN_OK);
+    runUntil(SCREEN_HATCH, 10);
+    capture();
+
+    press(SIM_BTN_OK);                                   // hatch animation
+    if (!runUntil(SCREEN_HOME, 1000)) fprintf(stderr, "hatch never finished\n");
+    capture();
+    frames(2000);                                        // ~30 s: a few WiFi scans
+
+    press(SIM_BTN_OK);
+    capture();                                           // main menu
+
+    static const int pages[] = { 0, 1, 2, 5 };           // OK-back pages
+    for (int idx : pages) {
+        selectMainMenu(idx);
+        press(SIM_BTN_OK);
+        capture();
+        press(SIM_BTN_OK);
+        frames(20);
+    }
+
+    static const int lists[] = { 3, 4 };                 // controls, settings
+    for (int idx : lists) {
+        selectMainMenu(idx);
+        press(SIM_BTN_OK);
+        capture();
+        press(SIM_BTN_UP);                               // wraps to "Back"
+        press(SIM_BTN_OK);
+        frames(20);
+    }
+
+    selectMainMenu(6);
+    press(SIM_BTN_OK);
+    frames(20);
+
+    Pet& pet = petSim.state.pet;
+    pet.hunger = pet.happiness = pet.health = 0;
+    if (!runUntil(SCREEN_GAMEOVER, 100)) fprintf(stderr, "game over never reached\n");
+    capture();
+
+    printBusReport();
+    if (powerSeconds) printPowerReport();
+
+    if (!goldenDir.empty()) {
+        printf("golden: %s\n", goldenFailures ? "FAILED" : "ok");
+        return goldenFailures ? 1 : 0;
+    }
+    return 0;
+}